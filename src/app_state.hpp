@@ -1,7 +1,9 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <bitset>
 #include <chrono>
 #include <cstdlib>
 #include <deque>
@@ -11,6 +13,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <stop_token>
@@ -22,6 +25,7 @@
 #include "dbc_engine.hpp"
 #include "frame_buffer.hpp"
 #include "hardware.hpp"
+#include "io_reactor.hpp"
 
 struct ImFont;
 #include "logger.hpp"
@@ -52,6 +56,9 @@ struct bus_stats {
   float bus_load_pct{0.f};
   clock::time_point window_start{clock::now()};
 
+  uint64_t decode_full{0};
+  uint64_t decode_skipped{0};
+
   uint64_t error_frames{0};
   uint64_t bus_off_count{0};
   uint64_t error_passive_count{0};
@@ -105,6 +112,24 @@ struct bus_stats {
     st.last_source = f.source;
   }
 
+  // Folds in counters gathered separately, e.g. by an import worker.
+  void merge(const bus_stats& o) {
+    for (const auto& [id, st] : o.per_id) {
+      auto& d = per_id[id];
+      d.total_count += st.total_count;
+      d.window_count += st.window_count;
+      d.last_source = st.last_source;
+    }
+    total_frames += o.total_frames;
+    window_frames += o.window_frames;
+    window_bits += o.window_bits;
+    decode_full += o.decode_full;
+    decode_skipped += o.decode_skipped;
+    error_frames += o.error_frames;
+    bus_off_count += o.bus_off_count;
+    error_passive_count += o.error_passive_count;
+  }
+
   void record_slcan_status(uint8_t status) {
     last_slcan_status = status;
     if (status & 0x20) bus_off_count++;
@@ -118,6 +143,8 @@ struct bus_stats {
     window_bits = 0.0;
     total_rate_hz = 0.f;
     bus_load_pct = 0.f;
+    decode_full = 0;
+    decode_skipped = 0;
     error_frames = 0;
     bus_off_count = 0;
     error_passive_count = 0;
@@ -134,6 +161,52 @@ struct app_state {
     std::optional<std::jthread> io_thread;
     std::atomic<bool> io_paused{false};
     dbc_engine slot_dbc;
+    std::mutex filter_mutex;
+    std::vector<rx_filter> sw_filters;
+    std::atomic<bool> sw_filtering{false};
+
+    result<filter_mode> set_filters(std::span<const rx_filter> filters) {
+      auto mode = adapter_set_filters(hw, filters);
+      std::lock_guard lock(filter_mutex);
+      sw_filters.assign(filters.begin(), filters.end());
+      sw_filtering.store(!filters.empty() &&
+                         (!mode || *mode != filter_mode::hardware));
+      return mode;
+    }
+
+    int reactor_fd{-1};
+    // Set on the reactor thread when the fd hangs up; reported by
+    // poll_frames().
+    std::atomic<bool> io_hung_up{false};
+
+    result<std::size_t> pump(unsigned timeout_ms) {
+      auto out = rx_buf.prepare(k_recv_batch);
+      auto result = adapter_recv_into(hw, out, timeout_ms);
+      if (!result) {
+        if (std::getenv("JCAN_DEBUG"))
+          std::fprintf(stderr, "[io] recv error: %s\n",
+                       to_string(result.error()));
+        return result;
+      }
+      auto n = *result;
+      if (sw_filtering.load()) {
+        std::lock_guard lock(filter_mutex);
+        n = apply_filters(sw_filters, out.first(n));
+      }
+      rx_buf.commit(n);
+      return result;
+    }
+
+    void pump_ready() {
+      if (io_paused.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return;
+      }
+      for (int i = 0; i < 8; ++i) {
+        auto n = pump(0);
+        if (!n || *n == 0) break;
+      }
+    }
 
     void start_io() {
       io_thread.emplace([this](std::stop_token stop) {
@@ -142,14 +215,7 @@ struct app_state {
             std::this_thread::sleep_for(std::chrono::milliseconds(5));
             continue;
           }
-          auto result = adapter_recv_many(hw, 50);
-          if (!result) {
-            if (std::getenv("JCAN_DEBUG"))
-              std::fprintf(stderr, "[io] recv error: %s\n",
-                           to_string(result.error()));
-            continue;
-          }
-          for (auto& f : *result) rx_buf.push(f);
+          (void)pump(50);
         }
       });
     }
@@ -160,6 +226,10 @@ struct app_state {
   int selected_device{0};
   int selected_bitrate{6};
   std::vector<std::unique_ptr<adapter_slot>> adapter_slots;
+#ifdef __linux__
+  io_reactor reactor;
+#endif
+  bool use_io_reactor{false};
   int tx_slot_idx{0};
   bool connected{false};
   bool log_mode{false};
@@ -192,6 +262,8 @@ struct app_state {
   bool monitor_freeze{false};
   char filter_text[64]{};
   char scrollback_filter_text[64]{};
+  char rx_filter_text[128]{};
+  std::vector<rx_filter> rx_filters;
   static constexpr std::size_t k_max_scrollback = 100'000;
 
   bool show_connection{true};
@@ -218,6 +290,37 @@ struct app_state {
   std::string session_log_path;
   signal_store signals;
 
+  // Maps one DBC engine's signal ids to channel ids in one signal_store, so
+  // the decode path neither builds strings nor hashes keys per sample. The
+  // live path also remembers each message's last payload and its decode.
+  struct cached_decode {
+    bool valid{false};
+    std::array<uint8_t, 64> data{};
+    std::vector<decoded_value> values;
+  };
+  struct signal_route {
+    uint64_t dbc_generation{0};
+    uint64_t store_generation{0};
+    std::vector<signal_store::channel_id> channels;
+    std::vector<cached_decode> last_decode;
+  };
+  std::array<signal_route, 256> signal_routes;
+  // Log decode runs in rounds of one k_decode_chunk per worker; each worker
+  // keeps its batches between rounds so their buffers are reused.
+  static constexpr std::size_t k_decode_chunk = 1 << 16;
+  static constexpr unsigned k_max_workers = 16;
+  struct decoded_piece {
+    uint8_t source{0};
+    const dbc_engine* dbc{nullptr};
+    dbc_engine::decoded_batch batch;
+  };
+  struct decode_worker {
+    std::vector<decoded_piece> pieces;
+    std::size_t used{0};
+    std::vector<can_frame> frames;
+  };
+  std::vector<decode_worker> decode_workers;
+
   struct log_layer {
     std::string name;
     std::string path;
@@ -247,6 +350,15 @@ struct app_state {
 
   bus_stats stats;
 
+  struct import_outcome {
+    std::string message;
+    bool ok{false};
+  };
+  std::optional<std::jthread> import_thread;
+  std::atomic<bool> importing{false};
+  std::atomic<float> import_progress{0.f};
+  std::optional<import_outcome> import_done;
+
   std::optional<std::jthread> export_thread;
   std::atomic<bool> exporting{false};
   std::atomic<float> export_progress{0.f};
@@ -270,6 +382,12 @@ struct app_state {
     return empty_dbc();
   }
 
+  uint64_t dropped_frames() const {
+    uint64_t n = replay_buf.dropped();
+    for (const auto& slot : adapter_slots) n += slot->rx_buf.dropped();
+    return n;
+  }
+
   bool any_dbc_has_message(const can_frame& f) const {
     return dbc_for_frame(f).has_message(f.id);
   }
@@ -316,6 +434,148 @@ struct app_state {
     return {};
   }
 
+  static void sync_route(signal_route& route, const signal_store& store,
+                         const dbc_engine& dbc) {
+    if (route.dbc_generation == dbc.generation() &&
+        route.store_generation == store.generation())
+      return;
+    route.dbc_generation = dbc.generation();
+    route.store_generation = store.generation();
+    route.channels.assign(dbc.signal_count(), signal_store::k_no_channel);
+    route.last_decode.clear();
+  }
+
+  signal_store::channel_id route_channel(signal_route& route,
+                                         signal_store& store,
+                                         const dbc_engine& dbc,
+                                         uint32_t signal_id) {
+    sync_route(route, store, dbc);
+    auto& ch = route.channels[signal_id];
+    if (ch == signal_store::k_no_channel) {
+      const auto& meta = dbc.signal(signal_id);
+      ch = store.intern(signal_key{.msg_id = meta.msg_id, .name = meta.name},
+                        meta.unit, meta.minimum, meta.maximum);
+    }
+    return ch;
+  }
+
+  // Live path. A frame whose payload matches the last one seen for its
+  // message on this source reuses that decode instead of running it again.
+  void store_decoded(signal_store& store, signal_route& route,
+                     const can_frame& f) {
+    const auto& dbc = dbc_for_frame(f);
+    const auto* plan = dbc.find(f.id);
+    if (!plan) return;
+    sync_route(route, store, dbc);
+    if (route.last_decode.empty())
+      route.last_decode.resize(dbc.message_count());
+
+    auto& cached = route.last_decode[plan->index];
+    if (cached.valid && cached.data == f.data) {
+      ++stats.decode_skipped;
+    } else {
+      dbc.decode(*plan, f, cached.values);
+      cached.data = f.data;
+      cached.valid = true;
+      ++stats.decode_full;
+    }
+    for (const auto& v : cached.values)
+      store.push(route_channel(route, store, dbc, v.signal_id), f.timestamp,
+                 v.value);
+  }
+
+  static std::size_t worker_count(std::size_t items, std::size_t per_worker) {
+    std::size_t hw = std::clamp(std::thread::hardware_concurrency(), 1u,
+                                k_max_workers);
+    return std::clamp<std::size_t>((items + per_worker - 1) / per_worker, 1,
+                                   hw);
+  }
+
+  // Calls fn(0..n-1), all but the first on their own threads.
+  template <typename Fn>
+  static void run_parallel(std::size_t n, const Fn& fn) {
+    std::vector<std::jthread> threads;
+    threads.reserve(n > 0 ? n - 1 : 0);
+    for (std::size_t i = 1; i < n; ++i) threads.emplace_back([&fn, i] { fn(i); });
+    if (n > 0) fn(0);
+  }
+
+  // Decodes one chunk with one decode_batch per source present in it.
+  void decode_chunk(std::span<const can_frame> chunk, decode_worker& w) const {
+    std::bitset<256> sources;
+    for (const auto& f : chunk) sources.set(f.source);
+
+    w.used = 0;
+    for (std::size_t src = 0; src < sources.size(); ++src) {
+      if (!sources.test(src)) continue;
+      auto run = chunk;
+      if (sources.count() > 1) {
+        w.frames.clear();
+        for (const auto& f : chunk)
+          if (f.source == src) w.frames.push_back(f);
+        run = w.frames;
+      }
+      const auto& dbc = dbc_for_frame(run.front());
+      if (!dbc.loaded()) continue;
+      if (w.used == w.pieces.size()) w.pieces.emplace_back();
+      auto& piece = w.pieces[w.used++];
+      piece.source = static_cast<uint8_t>(src);
+      piece.dbc = &dbc;
+      dbc.decode_batch(run, piece.batch);
+    }
+  }
+
+  // Decodes consecutive k_decode_chunk slices of `frames` in parallel, one
+  // per worker.
+  void decode_round(std::span<const can_frame> frames,
+                    std::span<decode_worker> workers) const {
+    auto chunks = (frames.size() + k_decode_chunk - 1) / k_decode_chunk;
+    run_parallel(chunks, [&](std::size_t c) {
+      auto off = c * k_decode_chunk;
+      decode_chunk(
+          frames.subspan(off, std::min(k_decode_chunk, frames.size() - off)),
+          workers[c]);
+    });
+  }
+
+  // Appends the workers' batches to the store in frame order.
+  void append_decoded(signal_store& store, std::span<signal_route> routes,
+                      std::span<const decode_worker> workers) {
+    for (const auto& w : workers) {
+      for (std::size_t i = 0; i < w.used; ++i) {
+        const auto& piece = w.pieces[i];
+        const auto& columns = piece.batch.columns;
+        for (uint32_t id = 0; id < columns.size(); ++id) {
+          if (columns[id].times.empty()) continue;
+          store.append(
+              route_channel(routes[piece.source], store, *piece.dbc, id),
+              columns[id].times, columns[id].values);
+        }
+      }
+    }
+  }
+
+  // Bulk path for logs: workers decode consecutive chunks into their own
+  // columnar batches, then the columns are appended to the store in frame
+  // order. Progress goes to import_progress.
+  void store_decoded_batch(signal_store& store, std::span<signal_route> routes,
+                           std::span<const can_frame> frames) {
+    if (frames.empty()) return;
+    auto workers = worker_count(frames.size(), k_decode_chunk);
+    if (decode_workers.size() < workers) decode_workers.resize(workers);
+
+    auto round = workers * k_decode_chunk;
+    for (std::size_t pos = 0; pos < frames.size(); pos += round) {
+      auto slice = frames.subspan(pos, std::min(round, frames.size() - pos));
+      auto chunks = (slice.size() + k_decode_chunk - 1) / k_decode_chunk;
+      auto used = std::span(decode_workers).first(chunks);
+      decode_round(slice, used);
+      append_decoded(store, routes, used);
+      import_progress.store(static_cast<float>(pos + slice.size()) /
+                            static_cast<float>(frames.size()));
+    }
+  }
+
   std::vector<decoded_signal> any_decode(const can_frame& f) const {
     return dbc_for_frame(f).decode(f);
   }
@@ -453,6 +713,10 @@ struct app_state {
 
   void connect() {
     if (devices.empty()) return;
+    if (importing.load()) {
+      status_text = "Wait for the log import to finish";
+      return;
+    }
     const auto& desc = devices[static_cast<std::size_t>(selected_device)];
 
     if (desc.kind == adapter_kind::unbound) {
@@ -506,7 +770,8 @@ struct app_state {
       }
     }
     for (auto& s : adapter_slots) s->io_paused.store(false);
-    slot->start_io();
+    if (!rx_filters.empty()) (void)slot->set_filters(rx_filters);
+    start_slot_io(*slot);
     adapter_slots.push_back(std::move(slot));
     connected = true;
     log_mode = false;
@@ -549,10 +814,54 @@ struct app_state {
     logger.start_csv(path);
   }
 
+  // Adapters with a pollable fd share the reactor thread when it is enabled;
+  // everything else keeps a dedicated blocking reader.
+  void start_slot_io(adapter_slot& slot) {
+#ifdef __linux__
+    if (use_io_reactor) {
+      int fd = adapter_poll_fd(slot.hw);
+      if (fd >= 0 &&
+          reactor.add(
+              fd, [&slot] { slot.pump_ready(); },
+              [&slot] { slot.io_hung_up.store(true); })) {
+        slot.reactor_fd = fd;
+        return;
+      }
+    }
+#endif
+    slot.start_io();
+  }
+
+  void stop_slot_io(adapter_slot& slot) {
+#ifdef __linux__
+    if (slot.reactor_fd >= 0) {
+      reactor.remove(slot.reactor_fd);
+      slot.reactor_fd = -1;
+    }
+#endif
+    slot.stop_io();
+  }
+
+  void set_rx_filters(std::vector<rx_filter> filters) {
+    rx_filters = std::move(filters);
+    int pushed = 0;
+    for (auto& slot : adapter_slots) {
+      auto mode = slot->set_filters(rx_filters);
+      if (mode && *mode != filter_mode::software) ++pushed;
+    }
+    if (rx_filters.empty())
+      status_text = "Acceptance filter cleared";
+    else
+      status_text = std::format(
+          "Acceptance filter: {} rule{}, {}/{} adapter{} in hardware",
+          rx_filters.size(), rx_filters.size() > 1 ? "s" : "", pushed,
+          adapter_slots.size(), adapter_slots.size() == 1 ? "" : "s");
+  }
+
   void disconnect_slot(int idx) {
     if (idx < 0 || idx >= static_cast<int>(adapter_slots.size())) return;
     if (idx == tx_slot_idx) tx_sched.stop();
-    adapter_slots[static_cast<std::size_t>(idx)]->stop_io();
+    stop_slot_io(*adapter_slots[static_cast<std::size_t>(idx)]);
     (void)adapter_close(adapter_slots[static_cast<std::size_t>(idx)]->hw);
     adapter_slots.erase(adapter_slots.begin() + idx);
 
@@ -577,7 +886,7 @@ struct app_state {
     tx_sched.stop();
     logger.stop();
     for (auto& slot : adapter_slots) {
-      slot->stop_io();
+      stop_slot_io(*slot);
       (void)adapter_close(slot->hw);
     }
     adapter_slots.clear();
@@ -585,17 +894,40 @@ struct app_state {
     status_text = "Disconnected";
   }
 
-  void poll_frames() {
-    std::vector<can_frame> frames;
+  // Ingest, stats, logging and decode run on this thread. Everything it
+  // touches is guarded by data_mutex, which the UI holds while it handles
+  // events and builds a frame, but not while it waits on vsync or sleeps.
+  void start_pipeline() {
+    pipeline_thread.emplace([this](std::stop_token stop) {
+      while (!stop.stop_requested()) {
+        {
+          std::lock_guard lk(data_mutex);
+          pipeline_frames += poll_frames();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+
+  void stop_pipeline() { pipeline_thread.reset(); }
+
+  std::size_t poll_frames() {
+    auto& frames = poll_scratch;
+    frames.clear();
     for (std::size_t si = 0; si < adapter_slots.size(); ++si) {
-      auto slot_frames = adapter_slots[si]->rx_buf.drain();
-      for (auto& f : slot_frames) f.source = static_cast<uint8_t>(si);
-      frames.insert(frames.end(), slot_frames.begin(), slot_frames.end());
+      auto& slot = *adapter_slots[si];
+      if (slot.io_hung_up.exchange(false)) {
+        slot.reactor_fd = -1;
+        status_text = std::format("Adapter hung up: {}", slot.desc.port);
+      }
+      auto first = frames.size();
+      adapter_slots[si]->rx_buf.drain_into(frames);
+      for (auto i = first; i < frames.size(); ++i)
+        frames[i].source = static_cast<uint8_t>(si);
     }
-    auto replay_frames = replay_buf.drain();
-    frames.insert(frames.end(), replay_frames.begin(), replay_frames.end());
+    replay_buf.drain_into(frames);
 
-    (void)tx_sched.drain_sent();
+    tx_sched.discard_sent();
 
     for (auto& f : frames) {
       if (!has_first_frame) {
@@ -611,14 +943,7 @@ struct app_state {
       while (scrollback.size() > k_max_scrollback) scrollback.pop_front();
       logger.log(f);
 
-      if (dbc_for_frame(f).has_message(f.id)) {
-        auto decoded = dbc_for_frame(f).decode(f);
-        for (const auto& sig : decoded) {
-          signals.push(signal_key{.msg_id = f.id, .name = sig.name},
-                       f.timestamp, sig.value, sig.unit, sig.minimum,
-                       sig.maximum);
-        }
-      }
+      store_decoded(signals, signal_routes[f.source], f);
 
       if (!monitor_freeze) {
         monitor_key mk{f.id, f.extended, f.source};
@@ -635,6 +960,7 @@ struct app_state {
         }
       }
     }
+    return frames.size();
   }
 
   void toggle_freeze() {
@@ -701,6 +1027,19 @@ struct app_state {
   }
 
   bool charts_dirty{false};
+  std::vector<can_frame> poll_scratch;
+  std::mutex data_mutex;
+  std::optional<std::jthread> pipeline_thread;
+  uint64_t pipeline_frames{0};
+
+  // The workers lock data_mutex and write members declared before it, so
+  // they are joined before any of those go away.
+  ~app_state() {
+    stop_pipeline();
+    replay_thread.reset();
+    import_thread.reset();
+    export_thread.reset();
+  }
 
   void clear_monitor() {
     monitor_rows.clear();
@@ -714,88 +1053,215 @@ struct app_state {
     charts_dirty = true;
   }
 
-  float import_log(std::vector<std::pair<int64_t, can_frame>> frames) {
-    if (frames.empty()) return 0.f;
-    log_mode = true;
-    log_dbc.clear();
-    clear_monitor();
+  // Per-worker share of an import: stats, the surviving frames and monitor
+  // rows for one contiguous slice of the log.
+  struct import_partition {
+    bus_stats stats;
+    std::vector<can_frame> frames;
+    std::vector<frame_row> rows;
+    std::unordered_map<monitor_key, int, monitor_key_hash> index;
+    std::bitset<256> sources;
+  };
+
+  struct prepared_import {
+    std::vector<import_partition> parts;
+    can_frame::clock::time_point base_time{};
+    double duration_sec{0};
+  };
+
+  // The expensive half of an import; touches nothing but `frames` and
+  // import_progress, so it can run without data_mutex.
+  prepared_import prepare_import(
+      std::vector<std::pair<int64_t, can_frame>>& frames) {
+    prepared_import out;
+    if (frames.empty()) return out;
 
     int64_t first_ts = frames.front().first;
     int64_t last_ts = frames.back().first;
-    double duration_sec = static_cast<double>(last_ts - first_ts) / 1e6;
-    if (duration_sec < 0.1) duration_sec = 1.0;
+    out.duration_sec = static_cast<double>(last_ts - first_ts) / 1e6;
+    if (out.duration_sec < 0.1) out.duration_sec = 1.0;
+    out.base_time =
+        can_frame::clock::now() - std::chrono::microseconds(last_ts - first_ts);
+
+    auto parts = worker_count(frames.size(), k_decode_chunk);
+    out.parts.resize(parts);
+    std::atomic<std::size_t> done{0};
+    run_parallel(parts, [&](std::size_t p) {
+      auto begin = frames.size() * p / parts;
+      auto end = frames.size() * (p + 1) / parts;
+      auto& part = out.parts[p];
+      part.frames.reserve(end - begin);
+
+      for (auto i = begin; i < end; ++i) {
+        auto& [ts_us, f] = frames[i];
+        f.timestamp = out.base_time + std::chrono::microseconds(ts_us - first_ts);
+        part.sources.set(f.source);
+        part.stats.record(f);
+        if (!f.error) {
+          part.frames.push_back(f);
+          monitor_key mk{f.id, f.extended, f.source};
+          auto [it, inserted] = part.index.try_emplace(
+              mk, static_cast<int>(part.rows.size()));
+          if (inserted) {
+            part.rows.push_back({.frame = f, .count = 1, .dt_ms = 0.f});
+          } else {
+            auto& row = part.rows[static_cast<std::size_t>(it->second)];
+            auto dt = f.timestamp - row.frame.timestamp;
+            row.dt_ms = std::chrono::duration<float, std::milli>(dt).count();
+            row.frame = f;
+            row.count++;
+          }
+        }
+        if (((i - begin) & 0xFFFF) == 0xFFFF) {
+          auto n = done.fetch_add(0x10000) + 0x10000;
+          import_progress.store(static_cast<float>(n) /
+                                static_cast<float>(frames.size()));
+        }
+      }
+    });
+    return out;
+  }
 
-    if (duration_sec > signals.max_seconds()) {
-      signals.set_max_seconds(duration_sec * 1.1);
-    }
+  // The cheap half: replaces the monitor, stats and signals with the
+  // prepared partitions, merged in log order.
+  float apply_import(prepared_import prep) {
+    if (prep.parts.empty()) return 0.f;
+    log_mode = true;
+    log_dbc.clear();
+    clear_monitor();
 
-    auto now = can_frame::clock::now();
-    auto log_duration = std::chrono::microseconds(last_ts - first_ts);
-    auto base_time = now - log_duration;
-    primary_base_time = base_time;
+    if (prep.duration_sec > signals.max_seconds())
+      signals.set_max_seconds(prep.duration_sec * 1.1);
+    signals.enable_spill();
+    primary_base_time = prep.base_time;
+    first_frame_time = prep.base_time;
+    has_first_frame = true;
 
     imported_frames.clear();
     log_channels.clear();
-
-    for (auto& [ts_us, f] : frames) {
-      f.timestamp = base_time + std::chrono::microseconds(ts_us - first_ts);
-      log_channels.insert(f.source);
-
-      if (!has_first_frame) {
-        first_frame_time = f.timestamp;
-        has_first_frame = true;
-      }
-
-      stats.record(f);
-      if (f.error) continue;
-
-      imported_frames.push_back(f);
-      scrollback.push_back(f);
-
-      if (dbc_for_frame(f).has_message(f.id)) {
-        auto decoded = dbc_for_frame(f).decode(f);
-        for (const auto& sig : decoded) {
-          signals.push(signal_key{.msg_id = f.id, .name = sig.name},
-                       f.timestamp, sig.value, sig.unit, sig.minimum,
-                       sig.maximum);
+    std::size_t total = 0;
+    for (const auto& part : prep.parts) total += part.frames.size();
+    imported_frames.reserve(total);
+
+    for (auto& part : prep.parts) {
+      stats.merge(part.stats);
+      for (std::size_t src = 0; src < part.sources.size(); ++src)
+        if (part.sources.test(src)) log_channels.insert(static_cast<uint8_t>(src));
+      imported_frames.insert(imported_frames.end(), part.frames.begin(),
+                             part.frames.end());
+
+      for (const auto& row : part.rows) {
+        monitor_key mk{row.frame.id, row.frame.extended, row.frame.source};
+        auto [it, inserted] =
+            monitor_index.try_emplace(mk, static_cast<int>(monitor_rows.size()));
+        if (inserted) {
+          monitor_rows.push_back(row);
+          continue;
         }
-      }
-
-      bool found = false;
-      for (auto& row : monitor_rows) {
-        if (row.frame.id == f.id && row.frame.extended == f.extended &&
-            row.frame.source == f.source) {
-          auto dt = f.timestamp - row.frame.timestamp;
-          row.dt_ms = std::chrono::duration<float, std::milli>(dt).count();
-          row.frame = f;
-          row.count++;
-          found = true;
-          break;
+        // A row seen only once in this partition has no dt of its own; take
+        // it from the row the earlier partitions left behind.
+        auto& dst = monitor_rows[static_cast<std::size_t>(it->second)];
+        if (row.count == 1) {
+          auto dt = row.frame.timestamp - dst.frame.timestamp;
+          dst.dt_ms = std::chrono::duration<float, std::milli>(dt).count();
+        } else {
+          dst.dt_ms = row.dt_ms;
         }
+        dst.frame = row.frame;
+        dst.count += row.count;
       }
-      if (!found) {
-        monitor_rows.push_back({.frame = f, .count = 1, .dt_ms = 0.f});
-      }
+      part = {};
     }
 
-    while (scrollback.size() > k_max_scrollback) scrollback.pop_front();
+    auto keep = std::min(imported_frames.size(), k_max_scrollback);
+    scrollback.assign(imported_frames.end() - static_cast<std::ptrdiff_t>(keep),
+                      imported_frames.end());
 
-    return static_cast<float>(duration_sec);
+    store_decoded_batch(signals, signal_routes, imported_frames);
+    import_progress.store(1.f);
+    return static_cast<float>(prep.duration_sec);
   }
 
+  float import_log(std::vector<std::pair<int64_t, can_frame>> frames) {
+    if (frames.empty()) return 0.f;
+    return apply_import(prepare_import(frames));
+  }
+
+  // Loads and prepares a CSV/ASC log on import_thread; only the final merge
+  // takes data_mutex. The result lands in import_done.
+  void start_import(const std::string& path) {
+    if (importing.load()) return;
+    import_thread.reset();
+    importing.store(true);
+    import_progress.store(0.f);
+
+    import_thread.emplace([this, path] {
+      auto ext = std::filesystem::path(path).extension().string();
+      for (auto& c : ext)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      auto frames = ext == ".asc" ? frame_logger::load_asc(path)
+                                  : frame_logger::load_csv(path);
+
+      import_outcome outcome;
+      if (frames.empty()) {
+        auto fname = std::filesystem::path(path).filename().string();
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) == 0 && !ec)
+          outcome.message = std::format("Import failed: {} is empty", fname);
+        else
+          outcome.message =
+              std::format("Import failed: no valid frames in {}", fname);
+        std::lock_guard lk(data_mutex);
+        import_done = std::move(outcome);
+      } else {
+        auto prep = prepare_import(frames);
+        frames = {};
+        std::lock_guard lk(data_mutex);
+        float dur = apply_import(std::move(prep));
+        outcome.message = std::format("Imported {} frames ({:.1f}s)",
+                                      scrollback.size(), dur);
+        outcome.ok = true;
+        import_done = std::move(outcome);
+      }
+      importing.store(false);
+    });
+  }
+
+  // Re-decodes the imported log after a log DBC change on import_thread.
+  // Each round is decoded without data_mutex and appended under it, so the
+  // UI keeps running. The UI keeps log_dbc and imported_frames unchanged,
+  // and stays disconnected, while importing is set.
   void redecode_log() {
-    if (!log_mode || imported_frames.empty()) return;
-    signals.clear();
-    for (const auto& f : imported_frames) {
-      if (dbc_for_frame(f).has_message(f.id)) {
-        auto decoded = dbc_for_frame(f).decode(f);
-        for (const auto& sig : decoded) {
-          signals.push(signal_key{.msg_id = f.id, .name = sig.name},
-                       f.timestamp, sig.value, sig.unit, sig.minimum,
-                       sig.maximum);
-        }
+    if (!log_mode || imported_frames.empty() || importing.load()) return;
+    import_thread.reset();
+    importing.store(true);
+    import_progress.store(0.f);
+
+    import_thread.emplace([this] {
+      std::span<const can_frame> frames = imported_frames;
+      std::vector<decode_worker> workers(
+          worker_count(frames.size(), k_decode_chunk));
+      auto round = workers.size() * k_decode_chunk;
+      for (std::size_t pos = 0; pos < frames.size(); pos += round) {
+        auto slice = frames.subspan(pos, std::min(round, frames.size() - pos));
+        auto chunks = (slice.size() + k_decode_chunk - 1) / k_decode_chunk;
+        auto used = std::span(workers).first(chunks);
+        decode_round(slice, used);
+        std::lock_guard lk(data_mutex);
+        if (pos == 0) signals.clear();
+        append_decoded(signals, signal_routes, used);
+        import_progress.store(static_cast<float>(pos + slice.size()) /
+                              static_cast<float>(frames.size()));
       }
-    }
+
+      import_outcome outcome;
+      outcome.ok = true;
+      {
+        std::lock_guard lk(data_mutex);
+        import_done = std::move(outcome);
+      }
+      importing.store(false);
+    });
   }
 
   float import_motec(const motec::ld_file& ld) {
@@ -813,6 +1279,7 @@ struct app_state {
     if (duration_sec > signals.max_seconds()) {
       signals.set_max_seconds(duration_sec * 1.1);
     }
+    signals.enable_spill();
 
     auto now = can_frame::clock::now();
     auto log_duration = std::chrono::duration_cast<can_frame::clock::duration>(
@@ -868,18 +1335,17 @@ struct app_state {
     layer.base_time = primary_base_time;
     if (duration_sec > layer.signals.max_seconds())
       layer.signals.set_max_seconds(duration_sec * 1.1);
+    layer.signals.enable_spill();
 
+    std::vector<can_frame> decoded;
+    decoded.reserve(frames.size());
     for (auto& [ts_us, f] : frames) {
       f.timestamp = primary_base_time + std::chrono::microseconds(ts_us - first_ts);
       if (f.error) continue;
-      if (dbc_for_frame(f).has_message(f.id)) {
-        auto decoded = dbc_for_frame(f).decode(f);
-        for (const auto& sig : decoded)
-          layer.signals.push(signal_key{.msg_id = f.id, .name = sig.name},
-                             f.timestamp, sig.value, sig.unit, sig.minimum,
-                             sig.maximum);
-      }
+      decoded.push_back(f);
     }
+    std::vector<signal_route> routes(signal_routes.size());
+    store_decoded_batch(layer.signals, routes, decoded);
 
     auto dur = static_cast<float>(duration_sec);
     overlay_layers.push_back(std::move(layer));
@@ -902,6 +1368,7 @@ struct app_state {
     layer.base_time = primary_base_time;
     if (duration_sec > layer.signals.max_seconds())
       layer.signals.set_max_seconds(duration_sec * 1.1);
+    layer.signals.enable_spill();
 
     constexpr uint32_t motec_msg_id = 0;
     for (const auto& ch : ld.channels) {
@@ -0,0 +1,410 @@
+// Throughput benchmarks for the ingest-to-render pipeline. Each case reports
+// items/s and ns/item; run with an optional case-name filter, e.g.
+//   jcan_bench decode
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "app_state.hpp"
+#include "dbc_engine.hpp"
+#include "frame_buffer.hpp"
+#include "hardware.hpp"
+#include "logger.hpp"
+#include "signal_store.hpp"
+#include "types.hpp"
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+const void* volatile g_sink = nullptr;
+
+// Keeps the optimiser from discarding a result.
+template <typename T>
+void keep(const T& v) {
+  g_sink = &v;
+}
+
+struct bench_result {
+  uint64_t items{};
+  double seconds{};
+};
+
+void report(std::string_view name, const bench_result& r) {
+  double per_s = r.seconds > 0 ? static_cast<double>(r.items) / r.seconds : 0;
+  double ns = r.items ? r.seconds * 1e9 / static_cast<double>(r.items) : 0;
+  std::cout << std::format("{:<28} {:>14.0f} items/s {:>10.1f} ns/item\n",
+                           name, per_s, ns);
+}
+
+// Runs fn (which processes `batch` items per call) until min_seconds elapse.
+bench_result run_for(uint64_t batch, const std::function<void()>& fn,
+                     double min_seconds = 0.5) {
+  fn();
+  bench_result r;
+  auto start = bench_clock::now();
+  do {
+    fn();
+    r.items += batch;
+    r.seconds =
+        std::chrono::duration<double>(bench_clock::now() - start).count();
+  } while (r.seconds < min_seconds);
+  return r;
+}
+
+std::vector<jcan::can_frame> make_frames(std::size_t n) {
+  jcan::mock_adapter gen;
+  (void)gen.open("mock0:rate=1000000,ids=64,fd=10,payload=random,seed=1");
+  std::vector<jcan::can_frame> out(n);
+  std::size_t got = 0;
+  while (got < n) {
+    auto r = gen.recv_into(std::span(out).subspan(got), 100);
+    got += r.value_or(0);
+  }
+  auto t0 = out.front().timestamp;
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i].timestamp = t0 + std::chrono::microseconds(i * 100);
+    out[i].id = 0x100 + static_cast<uint32_t>(i % 8) * 0x10;
+    out[i].extended = false;
+    out[i].fd = false;
+    out[i].dlc = 8;
+  }
+  return out;
+}
+
+std::filesystem::path write_bench_dbc(const std::filesystem::path& dir) {
+  std::string dbc = "VERSION \"\"\n\nNS_ :\n\nBS_:\n\nBU_: ECU\n\n";
+  for (uint32_t m = 0; m < 8; ++m) {
+    uint32_t id = 0x100 + m * 0x10;
+    dbc += std::format("BO_ {} MSG_{:03X}: 8 ECU\n", id, id);
+    if (m == 7) {
+      dbc += " SG_ MUX M : 0|8@1+ (1,0) [0|255] \"\" ECU\n";
+      for (int k = 0; k < 4; ++k)
+        dbc += std::format(
+            " SG_ MUXED_{} m{} : 8|16@1+ (0.1,0) [0|6553.5] \"V\" ECU\n", k, k);
+    } else if (m % 2) {
+      for (int s = 0; s < 4; ++s)
+        dbc += std::format(
+            " SG_ SIG_{}_{} : {}|16@0- (0.01,0) [-327.68|327.67] \"unit\""
+            " ECU\n",
+            m, s, s * 16 + 7);
+    } else {
+      for (int s = 0; s < 8; ++s)
+        dbc += std::format(
+            " SG_ SIG_{}_{} : {}|8@1+ (0.5,-10) [-10|117.5] \"unit\" ECU\n", m,
+            s, s * 8);
+    }
+    dbc += "\n";
+  }
+  auto path = dir / "bench.dbc";
+  std::ofstream(path) << dbc;
+  return path;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string_view filter = argc > 1 ? argv[1] : "";
+  auto enabled = [&](std::string_view name) {
+    return filter.empty() || name.find(filter) != std::string_view::npos;
+  };
+
+  auto tmp = std::filesystem::temp_directory_path() / "jcan_bench";
+  std::filesystem::create_directories(tmp);
+
+  constexpr std::size_t k_batch = 4096;
+  auto frames = make_frames(k_batch);
+
+  jcan::dbc_engine dbc;
+  if (auto err = dbc.load(write_bench_dbc(tmp)); !err.empty()) {
+    std::cerr << err << '\n';
+    return 1;
+  }
+
+  if (enabled("frame_buffer")) {
+    jcan::frame_buffer<8192> buf;
+    std::vector<jcan::can_frame> out;
+    out.reserve(k_batch);
+    report("frame_buffer push+drain", run_for(k_batch, [&] {
+             for (const auto& f : frames) buf.push(f);
+             out.clear();
+             buf.drain_into(out);
+             keep(out);
+           }));
+  }
+
+  if (enabled("decode")) {
+    std::size_t mismatches = 0;
+    for (const auto& f : frames) {
+      auto a = dbc.decode(f);
+      auto b = dbc.decode_reference(f);
+      if (a.size() != b.size()) {
+        ++mismatches;
+        continue;
+      }
+      for (std::size_t i = 0; i < a.size(); ++i)
+        if (a[i].name != b[i].name || a[i].raw != b[i].raw ||
+            a[i].value != b[i].value)
+          ++mismatches;
+    }
+    {
+      jcan::dbc_engine::decoded_batch batch;
+      dbc.decode_batch(frames, batch);
+      std::vector<jcan::decoded_value> values;
+      std::vector<std::size_t> next(dbc.signal_count());
+      for (const auto& f : frames) {
+        dbc.decode(f, values);
+        for (const auto& v : values) {
+          const auto& col = batch.columns[v.signal_id];
+          auto k = next[v.signal_id]++;
+          if (k >= col.values.size() || col.values[k] != v.value ||
+              col.times[k] != f.timestamp)
+            ++mismatches;
+        }
+      }
+    }
+    if (mismatches)
+      std::cerr << std::format("decode: {} mismatches against dbcppp\n",
+                               mismatches);
+
+    report("dbc_engine::decode (dbcppp)", run_for(k_batch, [&] {
+             for (const auto& f : frames) {
+               auto d = dbc.decode_reference(f);
+               keep(d);
+             }
+           }));
+    report("dbc_engine::decode", run_for(k_batch, [&] {
+             for (const auto& f : frames) {
+               auto d = dbc.decode(f);
+               keep(d);
+             }
+           }));
+    report("dbc_engine::find", run_for(k_batch, [&] {
+             for (const auto& f : frames) {
+               const auto* plan = dbc.find(f.id);
+               keep(plan);
+             }
+           }));
+    std::vector<jcan::decoded_value> values;
+    report("dbc_engine::decode (ids)", run_for(k_batch, [&] {
+             for (const auto& f : frames) {
+               dbc.decode(f, values);
+               keep(values);
+             }
+           }));
+    jcan::dbc_engine::decoded_batch batch;
+    report("dbc_engine::decode_batch", run_for(k_batch, [&] {
+             dbc.decode_batch(frames, batch);
+             keep(batch);
+           }));
+  }
+
+  if (enabled("encode")) {
+    std::unordered_map<std::string, double> by_name;
+    std::vector<std::string> names;
+    std::vector<double> values;
+    for (int s = 0; s < 8; ++s) {
+      names.push_back(std::format("SIG_0_{}", s));
+      values.push_back(s * 2.5);
+      by_name[names.back()] = values.back();
+    }
+    report("dbc_engine::encode (map)", run_for(k_batch, [&] {
+             for (std::size_t i = 0; i < k_batch; ++i) {
+               auto f = dbc.encode(0x100, by_name);
+               keep(f);
+             }
+           }));
+    auto plan = dbc.compile_encoder(0x100, names);
+    jcan::can_frame f{};
+    report("dbc_engine::encode (plan)", run_for(k_batch, [&] {
+             for (std::size_t i = 0; i < k_batch; ++i) {
+               jcan::dbc_engine::encode(plan, values, f);
+               keep(f);
+             }
+           }));
+  }
+
+  if (enabled("signal_store")) {
+    jcan::signal_store store;
+    std::vector<jcan::signal_key> keys;
+    for (uint32_t m = 0; m < 8; ++m)
+      for (int s = 0; s < 8; ++s)
+        keys.push_back({0x100 + m * 0x10, std::format("SIG_{}_{}", m, s)});
+    auto t = jcan::signal_sample::clock::now();
+    report("signal_store::push", run_for(k_batch, [&] {
+             for (std::size_t i = 0; i < k_batch; ++i) {
+               t += std::chrono::microseconds(10);
+               store.push(keys[i % keys.size()], t, static_cast<double>(i));
+             }
+           }));
+
+    std::vector<jcan::signal_store::channel_id> ids;
+    for (const auto& k : keys) ids.push_back(store.intern(k));
+    report("signal_store::push (id)", run_for(k_batch, [&] {
+             for (std::size_t i = 0; i < k_batch; ++i) {
+               t += std::chrono::microseconds(10);
+               store.push(ids[i % ids.size()], t, static_cast<double>(i));
+             }
+           }));
+  }
+
+  for (auto kind : {jcan::frame_logger::format_kind::csv,
+                    jcan::frame_logger::format_kind::asc}) {
+    bool csv = kind == jcan::frame_logger::format_kind::csv;
+    auto name = csv ? std::string("csv") : std::string("asc");
+    auto path = tmp / ("bench." + name);
+    if (!enabled("logger") && !enabled(name)) continue;
+
+    jcan::frame_logger logger;
+    csv ? logger.start_csv(path) : logger.start_asc(path);
+    report("frame_logger write " + name, run_for(k_batch, [&] {
+             for (const auto& f : frames) logger.log(f);
+           }));
+    logger.stop();
+
+    logger.start(path);
+    for (int rep = 0; rep < 16; ++rep)
+      for (const auto& f : frames) logger.log(f);
+    logger.stop();
+    report("frame_logger load " + name,
+           run_for(k_batch * 16, [&] {
+             auto loaded = csv ? jcan::frame_logger::load_csv(path)
+                               : jcan::frame_logger::load_asc(path);
+             keep(loaded);
+           }));
+  }
+
+  if (enabled("slcan")) {
+    std::vector<std::string> lines;
+    for (const auto& f : frames) {
+      std::string line = std::format("t{:03X}{}", f.id, f.dlc);
+      for (uint8_t i = 0; i < f.dlc; ++i)
+        line += std::format("{:02X}", f.data[i]);
+      lines.push_back(std::move(line));
+    }
+    report("parse_slcan", run_for(k_batch, [&] {
+             for (const auto& l : lines) {
+               auto r = jcan::serial_slcan::parse_slcan(l);
+               keep(r);
+             }
+           }));
+  }
+
+  if (enabled("import")) {
+    constexpr std::size_t k_log_frames = 1 << 20;
+    std::vector<std::pair<int64_t, jcan::can_frame>> log;
+    log.reserve(k_log_frames);
+    for (std::size_t i = 0; i < k_log_frames; ++i)
+      log.emplace_back(static_cast<int64_t>(i) * 100, frames[i % k_batch]);
+
+    jcan::app_state state;
+    report("app_state::import_log", run_for(k_log_frames, [&] {
+             keep(state.import_log(log));
+           }));
+    (void)state.log_dbc[0].load(tmp / "bench.dbc");
+    report("app_state::redecode_log", run_for(k_log_frames, [&] {
+             state.redecode_log();
+             state.import_thread.reset();
+             keep(state.signals);
+           }));
+  }
+
+  // Signal storage footprint and decode throughput, over signals decoded
+  // from a real log when given one:
+  //   jcan_bench store [log.csv|log.asc dbc]
+  // and otherwise from a synthetic log with jittered timestamps and slowly
+  // changing payloads.
+  if (enabled("store")) {
+    std::vector<std::pair<int64_t, jcan::can_frame>> log;
+    auto dbc_path = tmp / "bench.dbc";
+    if (argc > 3) {
+      std::filesystem::path src = argv[2];
+      log = src.extension() == ".asc" ? jcan::frame_logger::load_asc(src)
+                                      : jcan::frame_logger::load_csv(src);
+      dbc_path = argv[3];
+    } else {
+      constexpr std::size_t k_log_frames = 1 << 20;
+      log.reserve(k_log_frames);
+      for (std::size_t i = 0; i < k_log_frames; ++i) {
+        auto f = frames[i % k_batch];
+        for (std::size_t b = 0; b < 8; ++b)
+          f.data[b] = static_cast<uint8_t>((i >> (8 + b)) + b * 37);
+        auto jitter = static_cast<int64_t>((i * 7919) % 23);
+        log.emplace_back(static_cast<int64_t>(i) * 100 + jitter, f);
+      }
+    }
+
+    jcan::app_state state;
+    state.import_log(log);
+    (void)state.log_dbc[0].load(dbc_path);
+    state.redecode_log();
+    state.import_thread.reset();
+    const auto& store = state.signals;
+    std::vector<const jcan::sample_series*> series;
+    for (const auto* ch : store.all_channels())
+      series.push_back(store.samples(ch->key));
+
+    auto samples = store.total_samples();
+    std::cout << std::format(
+        "{:<28} {:>14.2f} bytes/sample (raw {}, {} samples)\n",
+        "signal_store storage",
+        samples ? static_cast<double>(store.storage_bytes()) /
+                      static_cast<double>(samples)
+                : 0.0,
+        sizeof(int64_t) + sizeof(double), samples);
+    report("signal_store scan", run_for(samples, [&] {
+             double sum = 0;
+             for (const auto* s : series)
+               s->scan(0, s->size(), [&](auto, auto values) {
+                 for (double v : values) sum += v;
+               });
+             keep(sum);
+           }));
+  }
+
+  if (enabled("poll_frames")) {
+    jcan::app_state state;
+    state.log_dir = tmp / "logs";
+    state.devices = {jcan::device_descriptor{
+        .kind = jcan::adapter_kind::mock,
+        .port = "mock0:rate=200000,ids=64,payload=random,seed=2",
+        .friendly_name = "bench",
+    }};
+    state.connect();
+    if (state.adapter_slots.empty()) {
+      std::cerr << state.status_text << '\n';
+      return 1;
+    }
+    (void)state.adapter_slots[0]->slot_dbc.load(tmp / "bench.dbc");
+
+    bench_result r;
+    auto wall = bench_clock::now();
+    while (std::chrono::duration<double>(bench_clock::now() - wall).count() <
+           2.0) {
+      auto before = state.stats.total_frames;
+      auto t0 = bench_clock::now();
+      state.poll_frames();
+      r.seconds += std::chrono::duration<double>(bench_clock::now() - t0).count();
+      r.items += state.stats.total_frames - before;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    report("app_state::poll_frames", r);
+    std::cout << std::format("{:<28} {:>14} dropped\n", "",
+                             state.dropped_frames());
+    state.disconnect();
+  }
+
+  std::filesystem::remove_all(tmp);
+  return 0;
+}
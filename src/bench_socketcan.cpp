@@ -0,0 +1,171 @@
+// Compares per-frame read() against batched recvmmsg() on a SocketCAN
+// interface. Usage: jcan_bench_socketcan [iface=vcan0] [frames=200000]
+// [rate_hz=20000]. The interface must already be up, e.g.
+//   ip link add dev vcan0 type vcan && ip link set vcan0 up
+
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hardware_sock.hpp"
+
+namespace {
+
+using clock_type = jcan::can_frame::clock;
+
+int open_sender(const std::string& iface) {
+  int fd = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (fd < 0) return -1;
+  ::setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0);
+
+  struct ifreq ifr{};
+  std::strncpy(ifr.ifr_name, iface.c_str(), IFNAMSIZ - 1);
+  if (::ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  struct sockaddr_can addr{};
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = ifr.ifr_ifindex;
+  if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void send_paced(int fd, std::size_t frames, unsigned rate_hz) {
+  auto period = std::chrono::nanoseconds(1'000'000'000 / std::max(rate_hz, 1u));
+  auto next = clock_type::now();
+  for (std::size_t i = 0; i < frames; ++i) {
+    std::this_thread::sleep_until(next);
+    next += period;
+
+    struct ::can_frame raw{};
+    raw.can_id = 0x123;
+    raw.len = 8;
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     clock_type::now().time_since_epoch())
+                     .count();
+    std::memcpy(raw.data, &ns, sizeof(ns));
+    (void)::write(fd, &raw, sizeof(raw));
+  }
+}
+
+struct run_result {
+  std::size_t frames{};
+  uint64_t syscalls{};
+  double mean_us{};
+  double stddev_us{};
+  double p99_us{};
+};
+
+run_result run(jcan::socket_can& sock, int tx_fd, std::size_t frames,
+               unsigned rate_hz) {
+  std::vector<jcan::can_frame> buf(jcan::k_recv_batch);
+  std::vector<double> lat_us;
+  lat_us.reserve(frames);
+
+  std::vector<jcan::can_frame> stale(jcan::k_recv_batch);
+  while (sock.recv_into(stale, 0).value_or(0) > 0) {
+  }
+  auto syscalls0 = sock.rx_syscalls_;
+
+  std::jthread sender([&] { send_paced(tx_fd, frames, rate_hz); });
+  auto deadline = clock_type::now() +
+                  std::chrono::milliseconds(frames * 1000 / rate_hz + 2000);
+  while (lat_us.size() < frames && clock_type::now() < deadline) {
+    auto n = sock.recv_into(buf, 100);
+    if (!n) break;
+    for (std::size_t i = 0; i < *n; ++i) {
+      int64_t sent_ns = 0;
+      std::memcpy(&sent_ns, buf[i].data.data(), sizeof(sent_ns));
+      auto rx_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       buf[i].timestamp.time_since_epoch())
+                       .count();
+      lat_us.push_back(static_cast<double>(rx_ns - sent_ns) / 1000.0);
+    }
+  }
+  sender.join();
+
+  run_result r;
+  r.frames = lat_us.size();
+  r.syscalls = sock.rx_syscalls_ - syscalls0;
+  if (lat_us.empty()) return r;
+
+  double sum = 0;
+  for (double v : lat_us) sum += v;
+  r.mean_us = sum / static_cast<double>(lat_us.size());
+  double var = 0;
+  for (double v : lat_us) var += (v - r.mean_us) * (v - r.mean_us);
+  r.stddev_us = std::sqrt(var / static_cast<double>(lat_us.size()));
+  std::sort(lat_us.begin(), lat_us.end());
+  r.p99_us = lat_us[lat_us.size() * 99 / 100];
+  return r;
+}
+
+void report(const char* name, const run_result& r) {
+  double per_frame =
+      r.frames ? static_cast<double>(r.syscalls) / static_cast<double>(r.frames)
+               : 0.0;
+  std::cout << std::format(
+      "{:<10} frames={:<8} syscalls/frame={:<7.3f} ts offset mean={:.1f}us "
+      "jitter(stddev)={:.1f}us p99={:.1f}us\n",
+      name, r.frames, per_frame, r.mean_us, r.stddev_us, r.p99_us);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string iface = argc > 1 ? argv[1] : "vcan0";
+  std::size_t frames = argc > 2 ? std::stoul(argv[2]) : 200000;
+  unsigned rate_hz = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3]))
+                              : 20000;
+
+  jcan::socket_can sock;
+  if (!sock.iface_is_up(iface)) {
+    std::cerr << std::format("{} is not up\n", iface);
+    return 1;
+  }
+  if (auto r = sock.open(iface); !r) {
+    std::cerr << std::format("open {}: {}\n", iface, jcan::to_string(r.error()));
+    return 1;
+  }
+  int tx_fd = open_sender(iface);
+  if (tx_fd < 0) {
+    std::cerr << std::format("cannot open sender socket on {}\n", iface);
+    return 1;
+  }
+
+  const char* ts_name =
+      sock.ts_source_ == jcan::socket_can::timestamp_source::hardware ? "hardware"
+      : sock.ts_source_ == jcan::socket_can::timestamp_source::kernel
+          ? "kernel"
+          : "user";
+  std::cout << std::format("{}: {} frames at {} Hz, timestamps: {}\n", iface,
+                           frames, rate_hz, ts_name);
+
+  sock.batched_rx_ = false;
+  report("read()", run(sock, tx_fd, frames, rate_hz));
+  sock.batched_rx_ = true;
+  report("recvmmsg", run(sock, tx_fd, frames, rate_hz));
+
+  ::close(tx_fd);
+  sock.iface_name_.clear();
+  (void)sock.close();
+  return 0;
+}
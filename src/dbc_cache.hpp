@@ -0,0 +1,231 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace jcan {
+
+// Read-only memory map of a whole file.
+class mapped_file {
+ public:
+  mapped_file() = default;
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+  ~mapped_file() { close(); }
+
+  bool open(const std::filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    file_ = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz{};
+    if (!::GetFileSizeEx(file_, &sz) || sz.QuadPart == 0) {
+      close();
+      return false;
+    }
+    mapping_ = ::CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+      close();
+      return false;
+    }
+    data_ = ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (!data_) {
+      close();
+      return false;
+    }
+    size_ = static_cast<std::size_t>(sz.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) < 0 || st.st_size == 0) {
+      ::close(fd);
+      return false;
+    }
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = p;
+    size_ = static_cast<std::size_t>(st.st_size);
+#endif
+    return true;
+  }
+
+  void close() {
+#ifdef _WIN32
+    if (data_) ::UnmapViewOfFile(data_);
+    if (mapping_) ::CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) ::CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_) ::munmap(data_, size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  [[nodiscard]] std::span<const uint8_t> bytes() const {
+    return {static_cast<const uint8_t*>(data_), size_};
+  }
+
+ private:
+  void* data_{nullptr};
+  std::size_t size_{0};
+#ifdef _WIN32
+  HANDLE file_{INVALID_HANDLE_VALUE};
+  HANDLE mapping_{nullptr};
+#endif
+};
+
+// On-disk cache of compiled DBC plans, one file per source path. A cache
+// file is only used when the source's mtime, size and content hash all
+// match what was recorded when it was written.
+namespace dbc_cache {
+
+inline constexpr char k_magic[8] = {'J', 'C', 'A', 'N', 'D', 'B', 'C', 0};
+inline constexpr uint32_t k_version = 2;
+
+struct header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  int64_t source_mtime;
+  uint64_t source_size;
+  uint64_t source_hash;
+  uint32_t message_count;
+  uint32_t signal_count;
+  uint64_t strings_bytes;
+};
+
+struct source_stamp {
+  int64_t mtime{0};
+  uint64_t size{0};
+  uint64_t hash{0};
+};
+
+inline uint64_t fnv1a(std::span<const uint8_t> bytes,
+                      uint64_t h = 0xcbf29ce484222325ULL) {
+  for (auto b : bytes) {
+    h ^= b;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+inline bool enabled() { return std::getenv("JCAN_NO_DBC_CACHE") == nullptr; }
+
+inline std::filesystem::path default_dir() {
+  if (const char* dir = std::getenv("JCAN_DBC_CACHE_DIR"))
+    return std::filesystem::path(dir);
+#ifdef _WIN32
+  const char* base = std::getenv("LOCALAPPDATA");
+  if (!base) base = std::getenv("APPDATA");
+  if (!base) return {};
+  return std::filesystem::path(base) / "jcan" / "dbc_cache";
+#else
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+    return std::filesystem::path(xdg) / "jcan" / "dbc";
+  const char* home = std::getenv("HOME");
+  if (!home) return {};
+  return std::filesystem::path(home) / ".cache" / "jcan" / "dbc";
+#endif
+}
+
+inline std::filesystem::path path_for(const std::filesystem::path& source) {
+  auto dir = default_dir();
+  if (dir.empty()) return {};
+  std::error_code ec;
+  auto abs = std::filesystem::absolute(source, ec).string();
+  auto key = fnv1a({reinterpret_cast<const uint8_t*>(abs.data()), abs.size()});
+  return dir / std::format("{:016x}.bin", key);
+}
+
+inline bool stamp(const std::filesystem::path& source, source_stamp& out) {
+  std::error_code ec;
+  auto mtime = std::filesystem::last_write_time(source, ec);
+  if (ec) return false;
+  mapped_file src;
+  if (!src.open(source)) return false;
+  out.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+  out.size = src.bytes().size();
+  out.hash = fnv1a(src.bytes());
+  return true;
+}
+
+// Writes via a temporary file so a concurrent reader never sees a partial
+// cache.
+inline bool write(const std::filesystem::path& dest, std::string_view blob) {
+  std::error_code ec;
+  std::filesystem::create_directories(dest.parent_path(), ec);
+  auto tmp = dest;
+  tmp += ".tmp";
+  {
+    std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) return false;
+    ofs.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+    if (!ofs) return false;
+  }
+  std::filesystem::rename(tmp, dest, ec);
+  if (ec) std::filesystem::remove(tmp, ec);
+  return !ec;
+}
+
+// Bounds-checked sequential reader over a mapped cache file.
+class reader {
+ public:
+  explicit reader(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  bool read(T& out) {
+    if (bytes_.size() - pos_ < sizeof(T)) return false;
+    std::memcpy(&out, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool take(std::size_t n, std::span<const uint8_t>& out) {
+    if (bytes_.size() - pos_ < n) return false;
+    out = bytes_.subspan(pos_, n);
+    pos_ += n;
+    return true;
+  }
+
+ private:
+  std::span<const uint8_t> bytes_;
+  std::size_t pos_{0};
+};
+
+template <typename T>
+void append(std::string& blob, const T& v) {
+  blob.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+}  // namespace dbc_cache
+
+}  // namespace jcan
@@ -3,15 +3,20 @@
 #include <dbcppp/Network.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>
-#include <fstream>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "dbc_network.hpp"
 #include "types.hpp"
 
 namespace jcan {
@@ -25,6 +30,16 @@ struct decoded_signal {
   double maximum;
 };
 
+// Signals are interned per engine at load; decode output refers to them by
+// a dense id and the name/unit live once in signal_meta.
+struct decoded_value {
+  uint32_t signal_id;
+  double raw;
+  double value;
+};
+
+
+
 struct signal_info {
   std::string name;
   std::string unit;
@@ -39,113 +54,286 @@ struct signal_info {
 
 class dbc_engine {
  public:
+  static constexpr std::size_t k_payload = compiled_network::k_payload;
+  static constexpr std::size_t k_padded_payload = k_payload + 8;
+
+  // A message as seen through this engine: the shared compiled message plus
+  // where its signals start in this engine's id space.
+  struct message_plan {
+    const compiled_message* compiled{nullptr};
+    const compiled_network* network{nullptr};
+    uint32_t index{0};
+    uint32_t signal_base{0};
+  };
+
+  // The id indexes point into plans_; moving keeps its buffer, copying
+  // would not.
+  dbc_engine() = default;
+  dbc_engine(const dbc_engine&) = delete;
+  dbc_engine& operator=(const dbc_engine&) = delete;
+  dbc_engine(dbc_engine&&) = default;
+  dbc_engine& operator=(dbc_engine&&) = default;
+
   [[nodiscard]] bool loaded() const { return !networks_.empty(); }
 
   [[nodiscard]] std::vector<std::string> filenames() const {
     std::vector<std::string> out;
     out.reserve(networks_.size());
-    for (const auto& n : networks_) out.push_back(n.filename);
+    for (const auto& n : networks_) out.push_back(n->filename);
     return out;
   }
 
   [[nodiscard]] const std::string& filename() const {
     static const std::string empty;
     if (networks_.empty()) return empty;
-    return networks_.front().filename;
+    return networks_.front()->filename;
   }
 
   [[nodiscard]] std::vector<std::string> paths() const {
     std::vector<std::string> out;
     out.reserve(networks_.size());
-    for (const auto& n : networks_) out.push_back(n.path);
+    for (const auto& n : networks_) out.push_back(n->path);
     return out;
   }
 
+  // Networks come from the process-wide registry, so a file loaded on several
+  // channels is parsed and compiled once.
   std::string load(const std::filesystem::path& path) {
     for (const auto& n : networks_) {
-      if (n.path == path.string()) return {};
-    }
-    std::ifstream ifs(path);
-    if (!ifs.is_open()) return "cannot open file: " + path.string();
-
-    try {
-      auto net = dbcppp::INetwork::LoadDBCFromIs(ifs);
-      if (!net) return "failed to parse DBC: " + path.filename().string();
-
-      loaded_network ln;
-      ln.net = std::move(net);
-      ln.filename = path.filename().string();
-      ln.path = path.string();
-      networks_.push_back(std::move(ln));
-      rebuild_index();
-      return {};
-    } catch (const std::exception& e) {
-      return std::string("DBC parse error: ") + e.what();
-    } catch (...) {
-      return "DBC parse error (unknown)";
+      if (n->path == path.string()) return {};
     }
+    std::string err;
+    auto net = dbc_registry::instance().acquire(path, err);
+    if (!net) return err;
+    networks_.push_back(std::move(net));
+    rebuild_index();
+    return {};
   }
 
   void unload() {
     networks_.clear();
-    msg_index_.clear();
+    rebuild_index();
   }
 
   void unload_one(const std::string& path) {
-    auto it =
-        std::remove_if(networks_.begin(), networks_.end(),
-                       [&](const loaded_network& n) { return n.path == path; });
+    auto it = std::remove_if(networks_.begin(), networks_.end(),
+                             [&](const auto& n) { return n->path == path; });
     if (it != networks_.end()) {
       networks_.erase(it, networks_.end());
       rebuild_index();
     }
   }
 
+  // One probe: a direct table for 11-bit ids, binary search above that.
+  [[nodiscard]] const message_plan* find(uint32_t id) const {
+    if (id < k_std_ids) return std_index_[id];
+    auto it = std::lower_bound(
+        ext_index_.begin(), ext_index_.end(), id,
+        [](const auto& e, uint32_t key) { return e.first < key; });
+    if (it == ext_index_.end() || it->first != id) return nullptr;
+    return it->second;
+  }
+
   [[nodiscard]] bool has_message(uint32_t id) const {
-    return msg_index_.contains(static_cast<uint64_t>(id));
+    return find(id) != nullptr;
   }
 
   [[nodiscard]] std::string message_name(uint32_t id) const {
-    auto it = msg_index_.find(static_cast<uint64_t>(id));
-    if (it == msg_index_.end()) return {};
-    return std::string(it->second->Name());
+    const auto* plan = find(id);
+    return plan ? plan->compiled->name : std::string{};
   }
 
   [[nodiscard]] uint8_t message_dlc(uint32_t id) const {
-    auto it = msg_index_.find(static_cast<uint64_t>(id));
-    if (it == msg_index_.end()) return 8;
-    return static_cast<uint8_t>(
-        std::min<uint64_t>(it->second->MessageSize(), 8));
+    const auto* plan = find(id);
+    return plan ? plan->compiled->dlc : uint8_t{8};
   }
 
   [[nodiscard]] std::vector<signal_info> signal_infos(uint32_t id) const {
     std::vector<signal_info> out;
-    auto it = msg_index_.find(static_cast<uint64_t>(id));
-    if (it == msg_index_.end()) return out;
+    const auto* plan = find(id);
+    if (!plan) return out;
 
-    for (const auto& sig : it->second->Signals()) {
+    const auto& sigs = plan->compiled->signals;
+    out.reserve(sigs.size());
+    for (const auto& sp : sigs) {
+      const auto& meta = *signals_[plan->signal_base + sp.id];
       out.push_back(signal_info{
-          .name = std::string(sig.Name()),
-          .unit = std::string(sig.Unit()),
-          .factor = sig.Factor(),
-          .offset = sig.Offset(),
-          .minimum = sig.Minimum(),
-          .maximum = sig.Maximum(),
-          .start_bit = sig.StartBit(),
-          .bit_size = sig.BitSize(),
-          .is_signed = sig.ValueType() == dbcppp::ISignal::EValueType::Signed,
+          .name = meta.name,
+          .unit = meta.unit,
+          .factor = sp.factor,
+          .offset = sp.offset,
+          .minimum = meta.minimum,
+          .maximum = meta.maximum,
+          .start_bit = sp.start_bit,
+          .bit_size = sp.bit_size,
+          .is_signed = sp.is_signed,
       });
     }
     return out;
   }
 
+  // Changes whenever the signal table is rebuilt, and is unique across
+  // engines, so ids cached against it can be checked cheaply.
+  [[nodiscard]] uint64_t generation() const { return generation_; }
+
+  [[nodiscard]] std::size_t signal_count() const { return signals_.size(); }
+  [[nodiscard]] std::size_t message_count() const { return plans_.size(); }
+
+  [[nodiscard]] const signal_meta& signal(uint32_t signal_id) const {
+    return *signals_[signal_id];
+  }
+
+  // Writes the frame's signals into `out` (cleared first) without allocating
+  // once `out` has grown; returns the number written.
+  std::size_t decode(const can_frame& frame,
+                     std::vector<decoded_value>& out) const {
+    const auto* plan = find(frame.id);
+    if (!plan) {
+      out.clear();
+      return 0;
+    }
+    return decode(*plan, frame, out);
+  }
+
+  // As above, for a plan the caller already obtained from find().
+  std::size_t decode(const message_plan& plan, const can_frame& frame,
+                     std::vector<decoded_value>& out) const {
+    out.clear();
+    std::array<uint8_t, k_padded_payload> data{};
+    std::memcpy(data.data(), frame.data.data(), frame.data.size());
+
+    for_each_active(*plan.compiled, data.data(), [&](const signal_plan& sp) {
+      double raw_val = 0;
+      double phys = evaluate(sp, data.data(), raw_val);
+      out.push_back(decoded_value{.signal_id = plan.signal_base + sp.id,
+                                  .raw = raw_val,
+                                  .value = phys});
+    });
+    return out.size();
+  }
+
+  // Columnar output of decode_batch(): one column per signal id, holding the
+  // samples in frame order. The remaining members are reusable scratch.
+  struct decoded_batch {
+    struct column {
+      std::vector<can_frame::clock::time_point> times;
+      std::vector<double> values;
+    };
+    std::vector<column> columns;
+
+    std::vector<uint32_t> group_start;
+    std::vector<uint32_t> group_of;
+    std::vector<uint32_t> cursor;
+    std::vector<uint32_t> order;
+    std::vector<std::array<uint8_t, k_padded_payload>> payloads;
+  };
+
+  // Decodes a run of frames message by message: frames are bucketed by
+  // compiled message, then each signal is extracted across its bucket in one
+  // pass. Multiplexed messages are walked frame by frame instead. Frames
+  // without a message in this engine are skipped.
+  void decode_batch(std::span<const can_frame> frames,
+                    decoded_batch& out) const {
+    out.columns.resize(signals_.size());
+    for (auto& c : out.columns) {
+      c.times.clear();
+      c.values.clear();
+    }
+    if (plans_.empty() || frames.empty()) return;
+
+    auto& start = out.group_start;
+    start.assign(plans_.size() + 1, 0);
+    out.group_of.resize(frames.size());
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+      const auto* plan = find(frames[i].id);
+      auto g = plan ? static_cast<uint32_t>(plan - plans_.data())
+                    : static_cast<uint32_t>(plans_.size());
+      out.group_of[i] = g;
+      if (plan) ++start[g + 1];
+    }
+    for (std::size_t g = 1; g < start.size(); ++g) start[g] += start[g - 1];
+
+    // Counting sort of frame indices by message; stable, so each bucket
+    // stays in frame order.
+    out.cursor.assign(start.begin(), start.end() - 1);
+    out.order.resize(start.back());
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+      auto g = out.group_of[i];
+      if (g < plans_.size())
+        out.order[out.cursor[g]++] = static_cast<uint32_t>(i);
+    }
+
+    for (std::size_t g = 0; g < plans_.size(); ++g) {
+      auto first = start[g];
+      auto count = start[g + 1] - first;
+      if (count == 0) continue;
+      const auto& plan = plans_[g];
+      const auto& cm = *plan.compiled;
+
+      out.payloads.resize(count);
+      for (uint32_t k = 0; k < count; ++k) {
+        auto& p = out.payloads[k];
+        const auto& f = frames[out.order[first + k]];
+        std::memcpy(p.data(), f.data.data(), f.data.size());
+        std::memset(p.data() + f.data.size(), 0, p.size() - f.data.size());
+      }
+      if (cm.multiplexed()) {
+        for (uint32_t k = 0; k < count; ++k) {
+          const auto* data = out.payloads[k].data();
+          auto t = frames[out.order[first + k]].timestamp;
+          for_each_active(cm, data, [&](const signal_plan& sp) {
+            auto& col = out.columns[plan.signal_base + sp.id];
+            double raw_val = 0;
+            col.values.push_back(evaluate(sp, data, raw_val));
+            col.times.push_back(t);
+          });
+        }
+        continue;
+      }
+
+      for (const auto& sp : cm.signals) {
+        auto& col = out.columns[plan.signal_base + sp.id];
+        col.times.reserve(col.times.size() + count);
+        col.values.reserve(col.values.size() + count);
+        for (uint32_t k = 0; k < count; ++k) {
+          double raw_val = 0;
+          col.values.push_back(evaluate(sp, out.payloads[k].data(), raw_val));
+          col.times.push_back(frames[out.order[first + k]].timestamp);
+        }
+      }
+    }
+  }
+
   [[nodiscard]] std::vector<decoded_signal> decode(
       const can_frame& frame) const {
+    std::vector<decoded_value> values;
+    decode(frame, values);
+    std::vector<decoded_signal> out;
+    out.reserve(values.size());
+    for (const auto& v : values) {
+      const auto& meta = *signals_[v.signal_id];
+      out.push_back(decoded_signal{
+          .name = meta.name,
+          .value = v.value,
+          .unit = meta.unit,
+          .raw = v.raw,
+          .minimum = meta.minimum,
+          .maximum = meta.maximum,
+      });
+    }
+    return out;
+  }
+
+  // Decodes through dbcppp's signal interface; kept as the reference the
+  // compiled plans are benchmarked and checked against.
+  [[nodiscard]] std::vector<decoded_signal> decode_reference(
+      const can_frame& frame) const {
     std::vector<decoded_signal> out;
-    auto it = msg_index_.find(static_cast<uint64_t>(frame.id));
-    if (it == msg_index_.end()) return out;
+    const auto* plan = find(frame.id);
+    if (!plan || !plan->network->ensure_parsed() || !plan->compiled->msg)
+      return out;
 
-    const auto* msg = it->second;
+    const auto* msg = plan->compiled->msg;
     const auto* mux_sig = msg->MuxSignal();
 
     for (const auto& sig : msg->Signals()) {
@@ -178,56 +366,276 @@ class dbc_engine {
     can_frame f{};
     f.id = id;
     f.extended = (id > 0x7FF);
-    std::memset(f.data.data(), 0, 64);
 
-    auto it = msg_index_.find(static_cast<uint64_t>(id));
-    if (it == msg_index_.end()) {
+    const auto* plan = find(id);
+    if (!plan) {
       f.dlc = 8;
       return f;
     }
+    f.dlc = plan->compiled->dlc;
 
-    const auto* msg = it->second;
-    f.dlc = static_cast<uint8_t>(std::min<uint64_t>(msg->MessageSize(), 8));
-
-    for (const auto& sig : msg->Signals()) {
-      auto sv = signal_values.find(std::string(sig.Name()));
+    std::array<uint8_t, k_padded_payload> data{};
+    for (const auto& sp : plan->compiled->signals) {
+      auto sv = signal_values.find(signals_[plan->signal_base + sp.id]->name);
       if (sv == signal_values.end()) continue;
-      uint64_t raw_val = sig.PhysToRaw(sv->second);
-      sig.Encode(raw_val, f.data.data());
+      write_signal(sp, sv->second, data.data());
     }
+    std::memcpy(f.data.data(), data.data(), f.data.size());
     f.timestamp = can_frame::clock::now();
     return f;
   }
 
+  // Encoder bound to one message and a fixed list of signal names, so
+  // periodic TX can encode from a value array without hashing names. Slots
+  // naming no signal of the message are null and ignored. Holds the network,
+  // so a plan stays valid after the engine unloads it.
+  struct encode_plan {
+    std::shared_ptr<const compiled_network> network;
+    const compiled_message* message{nullptr};
+    std::vector<const signal_plan*> slots;
+    uint64_t generation{0};
+    uint32_t id{0};
+  };
+
+  [[nodiscard]] encode_plan compile_encoder(
+      uint32_t id, std::span<const std::string> names) const {
+    encode_plan ep;
+    ep.id = id;
+    ep.generation = generation_;
+    const auto* plan = find(id);
+    if (!plan) return ep;
+
+    ep.message = plan->compiled;
+    for (const auto& n : networks_)
+      if (n.get() == plan->network) ep.network = n;
+    ep.slots.reserve(names.size());
+    for (const auto& name : names) {
+      const signal_plan* slot = nullptr;
+      for (const auto& sp : plan->compiled->signals) {
+        if (signals_[plan->signal_base + sp.id]->name == name) {
+          slot = &sp;
+          break;
+        }
+      }
+      ep.slots.push_back(slot);
+    }
+    return ep;
+  }
+
+  // Encodes values[i] into slot i; does not allocate.
+  static void encode(const encode_plan& ep, std::span<const double> values,
+                     can_frame& out) {
+    out = can_frame{};
+    out.id = ep.id;
+    out.extended = (ep.id > 0x7FF);
+    out.dlc = ep.message ? ep.message->dlc : uint8_t{8};
+    if (!ep.message) return;
+
+    std::array<uint8_t, k_padded_payload> data{};
+    auto n = std::min(values.size(), ep.slots.size());
+    for (std::size_t i = 0; i < n; ++i)
+      if (ep.slots[i]) write_signal(*ep.slots[i], values[i], data.data());
+    std::memcpy(out.data.data(), data.data(), out.data.size());
+    out.timestamp = can_frame::clock::now();
+  }
+
   [[nodiscard]] std::vector<uint32_t> message_ids() const {
     std::vector<uint32_t> ids;
-    ids.reserve(msg_index_.size());
-    for (const auto& [id, _] : msg_index_)
-      ids.push_back(static_cast<uint32_t>(id));
-    std::sort(ids.begin(), ids.end());
+    for (uint32_t id = 0; id < k_std_ids; ++id)
+      if (std_index_[id]) ids.push_back(id);
+    for (const auto& [id, _] : ext_index_) ids.push_back(id);
     return ids;
   }
 
  private:
-  struct loaded_network {
-    std::unique_ptr<dbcppp::INetwork> net;
-    std::string filename;
-    std::string path;
-  };
+  static uint64_t extract(const signal_plan& sp, const uint8_t* data) {
+    const uint8_t* p = data + sp.byte;
+    uint64_t raw = 0;
+    if (!sp.big_endian) {
+      uint64_t w = 0;
+      for (int i = 7; i >= 0; --i) w = (w << 8) | p[i];
+      raw = w >> sp.shift;
+      if (sp.shift + sp.bits > 64) raw |= uint64_t{p[8]} << (64 - sp.shift);
+      raw &= sp.mask;
+    } else {
+      uint64_t w = 0;
+      for (int i = 0; i < 8; ++i) w = (w << 8) | p[i];
+      raw = (w << sp.shift) >> (64 - sp.bits);
+      int spill = sp.shift + sp.bits - 64;
+      if (spill > 0) raw |= uint64_t{p[8]} >> (8 - spill);
+    }
+    if (sp.is_signed && sp.bits < 64 && ((raw >> (sp.bits - 1)) & 1))
+      raw |= ~sp.mask;
+    return raw;
+  }
+
+  // Inverse of extract(): writes the low `bits` of raw into the field,
+  // leaving the surrounding bits alone.
+  static void insert(const signal_plan& sp, uint64_t raw, uint8_t* data) {
+    uint8_t* p = data + sp.byte;
+    raw &= sp.mask;
+    int spill = sp.shift + sp.bits - 64;
+    if (!sp.big_endian) {
+      uint64_t w = 0;
+      for (int i = 7; i >= 0; --i) w = (w << 8) | p[i];
+      w = (w & ~(sp.mask << sp.shift)) | (raw << sp.shift);
+      for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(w >> (8 * i));
+      if (spill > 0) {
+        auto m = static_cast<uint8_t>((1u << spill) - 1);
+        p[8] = static_cast<uint8_t>((p[8] & ~m) |
+                                    ((raw >> (64 - sp.shift)) & m));
+      }
+    } else {
+      uint64_t w = 0;
+      for (int i = 0; i < 8; ++i) w = (w << 8) | p[i];
+      if (spill <= 0) {
+        int low = 64 - sp.shift - sp.bits;
+        w = (w & ~(sp.mask << low)) | (raw << low);
+      } else {
+        uint64_t field = (uint64_t{1} << (64 - sp.shift)) - 1;
+        w = (w & ~field) | (raw >> spill);
+        auto m = static_cast<uint8_t>(((1u << spill) - 1) << (8 - spill));
+        p[8] = static_cast<uint8_t>((p[8] & ~m) | ((raw << (8 - spill)) & m));
+      }
+      for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<uint8_t>(w);
+        w >>= 8;
+      }
+    }
+  }
+
+  // Physical to raw with rounding to the nearest step, so values that came
+  // from raw * factor + offset survive the round trip.
+  static void write_signal(const signal_plan& sp, double phys, uint8_t* data) {
+    if (sp.fallback) {
+      sp.sig->Encode(sp.sig->PhysToRaw(phys), data);
+      return;
+    }
+    double r = sp.factor != 0 ? (phys - sp.offset) / sp.factor
+                              : phys - sp.offset;
+    uint64_t raw = 0;
+    switch (sp.kind) {
+      case value_kind::float32:
+        raw = std::bit_cast<uint32_t>(static_cast<float>(r));
+        break;
+      case value_kind::float64:
+        raw = std::bit_cast<uint64_t>(r);
+        break;
+      default:
+        r = std::round(r);
+        if (sp.is_signed)
+          raw = static_cast<uint64_t>(static_cast<int64_t>(
+              std::clamp(r, -9.2e18, 9.2e18)));
+        else
+          raw = r > 0 ? static_cast<uint64_t>(std::min(r, 1.8e19)) : 0;
+        break;
+    }
+    insert(sp, raw, data);
+  }
+
+  static uint64_t raw_bits(const signal_plan& sp, const uint8_t* data) {
+    return sp.fallback ? sp.sig->Decode(data) : extract(sp, data);
+  }
+
+  // Visits the signals present in `data`: every signal of a plain message,
+  // otherwise the roots and, through each switch's table, only the signals
+  // its value selects.
+  template <typename Fn>
+  static void for_each_active(const compiled_message& cm, const uint8_t* data,
+                              Fn&& fn) {
+    if (!cm.multiplexed()) {
+      for (const auto& sp : cm.signals) fn(sp);
+      return;
+    }
+    visit_active(cm, cm.roots, data, fn);
+  }
+
+  template <typename Fn>
+  static void visit_active(const compiled_message& cm,
+                           std::span<const uint32_t> list, const uint8_t* data,
+                           Fn& fn) {
+    for (auto i : list) {
+      const auto& sp = cm.signals[i];
+      fn(sp);
+      if (auto t = cm.table_of[i]; t >= 0)
+        visit_active(cm, cm.tables[static_cast<std::size_t>(t)].active(
+                             raw_bits(sp, data)),
+                     data, fn);
+    }
+  }
+
+  static double evaluate(const signal_plan& sp, const uint8_t* data,
+                         double& raw_val) {
+    if (sp.fallback) {
+      auto raw = sp.sig->Decode(data);
+      raw_val = static_cast<double>(raw);
+      return sp.sig->RawToPhys(raw);
+    }
+    auto raw = extract(sp, data);
+    double v = 0;
+    switch (sp.kind) {
+      case value_kind::float32:
+        raw_val = static_cast<double>(raw);
+        v = std::bit_cast<float>(static_cast<uint32_t>(raw));
+        break;
+      case value_kind::float64:
+        raw_val = static_cast<double>(raw);
+        v = std::bit_cast<double>(raw);
+        break;
+      default:
+        raw_val = sp.is_signed ? static_cast<double>(static_cast<int64_t>(raw))
+                               : static_cast<double>(raw);
+        v = raw_val;
+        break;
+    }
+    return v * sp.factor + sp.offset;
+  }
 
   void rebuild_index() {
-    msg_index_.clear();
-    for (const auto& ln : networks_) {
-      if (!ln.net) continue;
-      for (const auto& msg : ln.net->Messages()) {
-        uint64_t id = msg.Id() & 0x1FFFFFFF;
-        msg_index_[id] = &msg;
+    std_index_.fill(nullptr);
+    ext_index_.clear();
+    plans_.clear();
+    signals_.clear();
+    generation_ = ++next_generation_;
+    std::size_t count = 0;
+    for (const auto& n : networks_) count += n->messages.size();
+    plans_.reserve(count);
+
+    // Later networks override earlier ones for the same id.
+    for (const auto& n : networks_) {
+      auto base = static_cast<uint32_t>(signals_.size());
+      for (const auto& meta : n->signals) signals_.push_back(&meta);
+      for (const auto& cm : n->messages) {
+        plans_.push_back(message_plan{
+            .compiled = &cm,
+            .network = n.get(),
+            .index = static_cast<uint32_t>(plans_.size()),
+            .signal_base = base,
+        });
+        const auto* plan = &plans_.back();
+        if (cm.id < k_std_ids)
+          std_index_[cm.id] = plan;
+        else
+          ext_index_.emplace_back(cm.id, plan);
       }
     }
+    std::stable_sort(
+        ext_index_.begin(), ext_index_.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+    auto last = std::unique(
+        ext_index_.rbegin(), ext_index_.rend(),
+        [](const auto& a, const auto& b) { return a.first == b.first; });
+    ext_index_.erase(ext_index_.begin(), last.base());
   }
 
-  std::vector<loaded_network> networks_;
-  std::unordered_map<uint64_t, const dbcppp::IMessage*> msg_index_;
+  std::vector<std::shared_ptr<const compiled_network>> networks_;
+  std::vector<message_plan> plans_;
+  std::vector<const signal_meta*> signals_;
+  uint64_t generation_{0};
+  static inline std::atomic<uint64_t> next_generation_{0};
+  static constexpr uint32_t k_std_ids = 0x800;
+  std::array<const message_plan*, k_std_ids> std_index_{};
+  std::vector<std::pair<uint32_t, const message_plan*>> ext_index_;
 };
 
 }  // namespace jcan
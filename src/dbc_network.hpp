@@ -0,0 +1,588 @@
+#pragma once
+
+#include <dbcppp/Network.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "dbc_cache.hpp"
+
+namespace jcan {
+
+struct signal_meta {
+  uint32_t msg_id;
+  std::string name;
+  std::string unit;
+  double minimum;
+  double maximum;
+};
+
+enum class value_kind : uint8_t { integer, float32, float64 };
+
+// Flat extraction recipe for one signal: load eight bytes at `byte` in the
+// signal's byte order, shift and mask. Layouts that do not fit the padded
+// payload go through dbcppp instead. `id` indexes the owning network's
+// signal table.
+struct signal_plan {
+  const dbcppp::ISignal* sig{nullptr};
+  uint32_t id{0};
+  double factor{1};
+  double offset{0};
+  uint64_t mask{0};
+  uint16_t start_bit{0};
+  uint16_t bit_size{0};
+  uint16_t byte{0};
+  uint8_t shift{0};
+  uint8_t bits{0};
+  value_kind kind{value_kind::integer};
+  bool big_endian{false};
+  bool is_signed{false};
+  bool fallback{false};
+};
+
+struct mux_range {
+  uint64_t from;
+  uint64_t to;
+};
+
+// The switch a signal depends on (an index into the message's signals, or
+// -1) and the switch values for which it is present.
+struct mux_gate {
+  int32_t switch_index{-1};
+  std::vector<mux_range> ranges;
+};
+
+// Signals selected by one switch, split into segments of switch values
+// with the same active set. Narrow switches also get a direct value to
+// segment table. Members may themselves be switches (extended
+// multiplexing).
+struct mux_table {
+  static constexpr uint32_t k_none = ~uint32_t{0};
+
+  uint32_t switch_index{0};
+  std::vector<uint64_t> starts;
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> members;
+  std::vector<uint32_t> direct;
+
+  [[nodiscard]] std::span<const uint32_t> active(uint64_t value) const {
+    uint32_t seg = k_none;
+    if (value < direct.size()) {
+      seg = direct[value];
+    } else if (!starts.empty() && value >= starts.front()) {
+      seg = static_cast<uint32_t>(
+          std::upper_bound(starts.begin(), starts.end(), value) -
+          starts.begin() - 1);
+    }
+    if (seg == k_none) return {};
+    return std::span(members).subspan(offsets[seg],
+                                      offsets[seg + 1] - offsets[seg]);
+  }
+};
+
+// `msg` is null for networks restored from the binary cache until something
+// that needs dbcppp (encode, decode_reference) parses the file.
+//
+// Decoding starts from `roots`, the ungated signals; a signal with a
+// table_of entry is a switch whose table names the signals to decode next.
+// Signals on a gate cycle are unreachable and never decoded.
+struct compiled_message {
+  uint32_t id{0};
+  uint8_t dlc{8};
+  std::string name;
+  std::vector<signal_plan> signals;
+  std::vector<mux_gate> gates;
+  std::vector<uint32_t> roots;
+  std::vector<mux_table> tables;
+  std::vector<int32_t> table_of;
+  mutable const dbcppp::IMessage* msg{nullptr};
+
+  [[nodiscard]] bool multiplexed() const { return !tables.empty(); }
+
+  void build_mux() {
+    roots.clear();
+    tables.clear();
+    table_of.assign(signals.size(), -1);
+    for (uint32_t i = 0; i < gates.size(); ++i) {
+      auto sw = gates[i].switch_index;
+      if (sw < 0 || static_cast<std::size_t>(sw) >= signals.size()) {
+        roots.push_back(i);
+      } else if (table_of[static_cast<std::size_t>(sw)] < 0) {
+        table_of[static_cast<std::size_t>(sw)] =
+            static_cast<int32_t>(tables.size());
+        tables.emplace_back().switch_index = static_cast<uint32_t>(sw);
+      }
+    }
+
+    for (auto& t : tables) {
+      for (const auto& g : gates) {
+        if (g.switch_index != static_cast<int32_t>(t.switch_index)) continue;
+        for (const auto& r : g.ranges) {
+          t.starts.push_back(r.from);
+          if (r.to != ~uint64_t{0}) t.starts.push_back(r.to + 1);
+        }
+      }
+      std::sort(t.starts.begin(), t.starts.end());
+      t.starts.erase(std::unique(t.starts.begin(), t.starts.end()),
+                     t.starts.end());
+
+      t.offsets.assign(1, 0);
+      for (auto v : t.starts) {
+        for (uint32_t i = 0; i < gates.size(); ++i) {
+          const auto& g = gates[i];
+          if (g.switch_index != static_cast<int32_t>(t.switch_index)) continue;
+          bool hit = std::any_of(
+              g.ranges.begin(), g.ranges.end(),
+              [&](const auto& r) { return v >= r.from && v <= r.to; });
+          if (hit) t.members.push_back(i);
+        }
+        t.offsets.push_back(static_cast<uint32_t>(t.members.size()));
+      }
+
+      const auto& sp = signals[t.switch_index];
+      if (!sp.fallback && sp.bits <= k_direct_bits) {
+        t.direct.assign(std::size_t{1} << sp.bits, mux_table::k_none);
+        for (uint64_t v = 0; v < t.direct.size(); ++v) {
+          auto it = std::upper_bound(t.starts.begin(), t.starts.end(), v);
+          if (it != t.starts.begin())
+            t.direct[v] = static_cast<uint32_t>(it - t.starts.begin() - 1);
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr unsigned k_direct_bits = 10;
+};
+
+// One DBC file compiled into decode plans. Immutable once loaded, apart from
+// the lazily parsed dbcppp network, so one instance is shared by every
+// engine that loads the same file (see dbc_registry).
+class compiled_network {
+ public:
+  static constexpr std::size_t k_payload = 64;
+
+  std::string filename;
+  std::string path;
+  dbc_cache::source_stamp stamp;
+  std::vector<compiled_message> messages;
+  std::vector<signal_meta> signals;
+
+  // Restores compiled plans from the binary cache when the file is unchanged
+  // since it was cached; otherwise parses with dbcppp and refreshes the
+  // cache. Returns null and sets `err` on failure.
+  static std::shared_ptr<compiled_network> load(
+      const std::filesystem::path& file, std::string& err) {
+    auto net = std::make_shared<compiled_network>();
+    net->filename = file.filename().string();
+    net->path = file.string();
+
+    bool stamped = dbc_cache::stamp(file, net->stamp);
+    auto cache_path = stamped && dbc_cache::enabled()
+                          ? dbc_cache::path_for(file)
+                          : std::filesystem::path{};
+    if (!cache_path.empty() && net->read_cache(cache_path)) return net;
+
+    err = net->parse();
+    if (!err.empty()) return nullptr;
+    bool cacheable = net->compile();
+    if (!cache_path.empty() && cacheable) net->write_cache(cache_path);
+    return net;
+  }
+
+  // True when the file on disk no longer matches what was loaded.
+  [[nodiscard]] bool stale() const {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    return static_cast<int64_t>(mtime.time_since_epoch().count()) !=
+               stamp.mtime ||
+           size != stamp.size;
+  }
+
+  // Parses a cache-restored network and attaches its dbcppp messages. Only
+  // the paths that need dbcppp call this.
+  bool ensure_parsed() const {
+    std::lock_guard lk(parse_mutex_);
+    if (net_) return true;
+    if (!parse().empty()) return false;
+
+    std::size_t i = 0;
+    for (const auto& msg : net_->Messages()) {
+      auto id = static_cast<uint32_t>(msg.Id() & 0x1FFFFFFF);
+      // Cache order follows dbcppp's, so the guess almost always hits.
+      const compiled_message* cm =
+          i < messages.size() && messages[i].id == id ? &messages[i] : nullptr;
+      if (!cm) {
+        auto it = std::find_if(messages.begin(), messages.end(),
+                               [&](const auto& m) { return m.id == id; });
+        if (it != messages.end()) cm = &*it;
+      }
+      if (cm) cm->msg = &msg;
+      ++i;
+    }
+    return true;
+  }
+
+ private:
+  std::string parse() const {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) return "cannot open file: " + path;
+    try {
+      auto net = dbcppp::INetwork::LoadDBCFromIs(ifs);
+      if (!net) return "failed to parse DBC: " + filename;
+      net_ = std::move(net);
+      return {};
+    } catch (const std::exception& e) {
+      return std::string("DBC parse error: ") + e.what();
+    } catch (...) {
+      return "DBC parse error (unknown)";
+    }
+  }
+
+  static signal_plan compile_signal(const dbcppp::ISignal& sig, uint32_t id) {
+    signal_plan sp;
+    sp.sig = &sig;
+    sp.id = id;
+    sp.factor = sig.Factor();
+    sp.offset = sig.Offset();
+    sp.is_signed = sig.ValueType() == dbcppp::ISignal::EValueType::Signed;
+
+    auto bits = sig.BitSize();
+    auto start = sig.StartBit();
+    sp.start_bit = static_cast<uint16_t>(std::min<uint64_t>(start, 0xFFFF));
+    sp.bit_size = static_cast<uint16_t>(std::min<uint64_t>(bits, 0xFFFF));
+    sp.big_endian = sig.ByteOrder() == dbcppp::ISignal::EByteOrder::BigEndian;
+    // Motorola start bits name the MSB in sawtooth numbering; convert to a
+    // linear MSB-first bit position.
+    uint64_t first = sp.big_endian ? (start / 8) * 8 + (7 - start % 8) : start;
+
+    switch (sig.ExtendedValueType()) {
+      case dbcppp::ISignal::EExtendedValueType::Float:
+        sp.kind = value_kind::float32;
+        break;
+      case dbcppp::ISignal::EExtendedValueType::Double:
+        sp.kind = value_kind::float64;
+        break;
+      default:
+        break;
+    }
+    if (sp.kind != value_kind::integer) sp.is_signed = false;
+    if (bits == 0 || bits > 64 || first + bits > k_payload * 8 ||
+        (sp.kind == value_kind::float32 && bits != 32) ||
+        (sp.kind == value_kind::float64 && bits != 64)) {
+      sp.fallback = true;
+      return sp;
+    }
+    sp.bits = static_cast<uint8_t>(bits);
+    sp.byte = static_cast<uint16_t>(first / 8);
+    sp.shift = static_cast<uint8_t>(first % 8);
+    sp.mask = bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    return sp;
+  }
+
+  // SG_MUL_VAL_ entries (extended multiplexing) take precedence over the
+  // plain m<N> indicator, which refers to the message's top-level switch.
+  static mux_gate resolve_gate(const dbcppp::ISignal& sig,
+                               const std::vector<const dbcppp::ISignal*>& sigs,
+                               int32_t top) {
+    mux_gate g;
+    for (const auto& mv : sig.SignalMultiplexerValues()) {
+      auto it = std::find_if(sigs.begin(), sigs.end(), [&](const auto* s) {
+        return s->Name() == mv.SwitchName();
+      });
+      if (it == sigs.end() || mv.ValueRanges_Size() == 0) continue;
+      g.switch_index = static_cast<int32_t>(it - sigs.begin());
+      for (const auto& r : mv.ValueRanges())
+        g.ranges.push_back(mux_range{.from = r.from, .to = r.to});
+      return g;
+    }
+    if (sig.MultiplexerIndicator() == dbcppp::ISignal::EMultiplexer::MuxValue &&
+        top >= 0) {
+      auto v = sig.MultiplexerSwitchValue();
+      g.switch_index = top;
+      g.ranges.push_back(mux_range{.from = v, .to = v});
+    }
+    return g;
+  }
+
+  // Returns false when some signal needs dbcppp at decode time, which rules
+  // out caching.
+  bool compile() {
+    bool cacheable = true;
+    messages.clear();
+    signals.clear();
+    for (const auto& msg : net_->Messages()) {
+      compiled_message cm;
+      cm.msg = &msg;
+      cm.id = static_cast<uint32_t>(msg.Id() & 0x1FFFFFFF);
+      cm.dlc = static_cast<uint8_t>(std::min<uint64_t>(msg.MessageSize(), 8));
+      cm.name = std::string(msg.Name());
+      const auto* mux_sig = msg.MuxSignal();
+      std::vector<const dbcppp::ISignal*> sigs;
+      int32_t top = -1;
+      for (const auto& sig : msg.Signals()) {
+        if (&sig == mux_sig) top = static_cast<int32_t>(sigs.size());
+        sigs.push_back(&sig);
+      }
+      for (const auto* sig_ptr : sigs) {
+        const auto& sig = *sig_ptr;
+        cm.gates.push_back(resolve_gate(sig, sigs, top));
+        auto id = static_cast<uint32_t>(signals.size());
+        signals.push_back(signal_meta{
+            .msg_id = cm.id,
+            .name = std::string(sig.Name()),
+            .unit = std::string(sig.Unit()),
+            .minimum = sig.Minimum(),
+            .maximum = sig.Maximum(),
+        });
+        cm.signals.push_back(compile_signal(sig, id));
+        if (cm.signals.back().fallback) cacheable = false;
+      }
+      cm.build_mux();
+      messages.push_back(std::move(cm));
+    }
+    return cacheable;
+  }
+
+  // Cache layout: header, then per message a fixed record followed by its
+  // signal records and their mux ranges, then one string table. Names and
+  // units are stored as offset/length pairs into the table.
+  struct cached_message {
+    uint32_t id;
+    uint32_t signal_count;
+    uint32_t name_off;
+    uint32_t name_len;
+    uint8_t dlc;
+    uint8_t pad[3];
+  };
+
+  struct cached_signal {
+    double factor;
+    double offset;
+    double minimum;
+    double maximum;
+    uint64_t mask;
+    int32_t gate;
+    uint32_t range_count;
+    uint32_t name_off;
+    uint32_t name_len;
+    uint32_t unit_off;
+    uint32_t unit_len;
+    uint16_t start_bit;
+    uint16_t bit_size;
+    uint16_t byte;
+    uint8_t shift;
+    uint8_t bits;
+    uint8_t kind;
+    uint8_t flags;
+    uint8_t pad[6];
+  };
+
+  static constexpr uint32_t k_cache_byte_order = 0x01020304;
+
+  void write_cache(const std::filesystem::path& dest) const {
+    std::string strings;
+    auto intern = [&](const std::string& str, uint32_t& off, uint32_t& len) {
+      off = static_cast<uint32_t>(strings.size());
+      len = static_cast<uint32_t>(str.size());
+      strings += str;
+    };
+
+    std::string body;
+    for (const auto& cm : messages) {
+      cached_message rec{};
+      rec.id = cm.id;
+      rec.signal_count = static_cast<uint32_t>(cm.signals.size());
+      rec.dlc = cm.dlc;
+      intern(cm.name, rec.name_off, rec.name_len);
+      dbc_cache::append(body, rec);
+      for (std::size_t k = 0; k < cm.signals.size(); ++k) {
+        const auto& sp = cm.signals[k];
+        const auto& meta = signals[sp.id];
+        cached_signal cs{};
+        cs.factor = sp.factor;
+        cs.offset = sp.offset;
+        cs.minimum = meta.minimum;
+        cs.maximum = meta.maximum;
+        cs.mask = sp.mask;
+        cs.gate = cm.gates[k].switch_index;
+        cs.range_count = static_cast<uint32_t>(cm.gates[k].ranges.size());
+        intern(meta.name, cs.name_off, cs.name_len);
+        intern(meta.unit, cs.unit_off, cs.unit_len);
+        cs.start_bit = sp.start_bit;
+        cs.bit_size = sp.bit_size;
+        cs.byte = sp.byte;
+        cs.shift = sp.shift;
+        cs.bits = sp.bits;
+        cs.kind = static_cast<uint8_t>(sp.kind);
+        cs.flags = static_cast<uint8_t>((sp.big_endian ? 1 : 0) |
+                                        (sp.is_signed ? 2 : 0));
+        dbc_cache::append(body, cs);
+      }
+      for (const auto& g : cm.gates)
+        for (const auto& r : g.ranges) dbc_cache::append(body, r);
+    }
+
+    dbc_cache::header h{};
+    std::memcpy(h.magic, dbc_cache::k_magic, sizeof(h.magic));
+    h.version = dbc_cache::k_version;
+    h.byte_order = k_cache_byte_order;
+    h.source_mtime = stamp.mtime;
+    h.source_size = stamp.size;
+    h.source_hash = stamp.hash;
+    h.message_count = static_cast<uint32_t>(messages.size());
+    h.signal_count = static_cast<uint32_t>(signals.size());
+    h.strings_bytes = strings.size();
+
+    std::string blob;
+    blob.reserve(sizeof(h) + body.size() + strings.size());
+    dbc_cache::append(blob, h);
+    blob += body;
+    blob += strings;
+    (void)dbc_cache::write(dest, blob);
+  }
+
+  bool read_cache(const std::filesystem::path& src) {
+    mapped_file map;
+    if (!map.open(src)) return false;
+    dbc_cache::reader rd(map.bytes());
+
+    dbc_cache::header h{};
+    if (!rd.read(h) ||
+        std::memcmp(h.magic, dbc_cache::k_magic, sizeof(h.magic)) != 0 ||
+        h.version != dbc_cache::k_version ||
+        h.byte_order != k_cache_byte_order || h.source_mtime != stamp.mtime ||
+        h.source_size != stamp.size || h.source_hash != stamp.hash)
+      return false;
+
+    auto strings_at = map.bytes().size() - std::min<uint64_t>(
+                                               h.strings_bytes,
+                                               map.bytes().size());
+    auto strings = map.bytes().subspan(strings_at);
+    auto str = [&](uint32_t off, uint32_t len, std::string& out) {
+      if (uint64_t{off} + len > strings.size()) return false;
+      out.assign(reinterpret_cast<const char*>(strings.data()) + off, len);
+      return true;
+    };
+
+    std::vector<compiled_message> msgs;
+    std::vector<signal_meta> sigs;
+    msgs.reserve(h.message_count);
+    sigs.reserve(h.signal_count);
+    for (uint32_t m = 0; m < h.message_count; ++m) {
+      cached_message rec{};
+      if (!rd.read(rec)) return false;
+      compiled_message cm;
+      cm.id = rec.id;
+      cm.dlc = rec.dlc;
+      if (!str(rec.name_off, rec.name_len, cm.name)) return false;
+      cm.signals.reserve(rec.signal_count);
+      cm.gates.resize(rec.signal_count);
+      for (uint32_t k = 0; k < rec.signal_count; ++k) {
+        cached_signal cs{};
+        if (!rd.read(cs)) return false;
+        if (cs.bits == 0 || cs.bits > 64 || cs.shift > 7 ||
+            std::size_t{cs.byte} * 8 + cs.shift + cs.bits > k_payload * 8 ||
+            cs.kind > static_cast<uint8_t>(value_kind::float64) ||
+            cs.gate >= static_cast<int32_t>(rec.signal_count) ||
+            uint64_t{cs.range_count} * sizeof(mux_range) > map.bytes().size())
+          return false;
+        cm.gates[k].switch_index = cs.gate;
+        cm.gates[k].ranges.resize(cs.range_count);
+        signal_meta meta{.msg_id = rec.id,
+                         .name = {},
+                         .unit = {},
+                         .minimum = cs.minimum,
+                         .maximum = cs.maximum};
+        if (!str(cs.name_off, cs.name_len, meta.name) ||
+            !str(cs.unit_off, cs.unit_len, meta.unit))
+          return false;
+
+        signal_plan sp;
+        sp.id = static_cast<uint32_t>(sigs.size());
+        sp.factor = cs.factor;
+        sp.offset = cs.offset;
+        sp.mask = cs.mask;
+        sp.start_bit = cs.start_bit;
+        sp.bit_size = cs.bit_size;
+        sp.byte = cs.byte;
+        sp.shift = cs.shift;
+        sp.bits = cs.bits;
+        sp.kind = static_cast<value_kind>(cs.kind);
+        sp.big_endian = cs.flags & 1;
+        sp.is_signed = cs.flags & 2;
+        sigs.push_back(std::move(meta));
+        cm.signals.push_back(sp);
+      }
+      for (auto& g : cm.gates)
+        for (auto& r : g.ranges)
+          if (!rd.read(r)) return false;
+      cm.build_mux();
+      msgs.push_back(std::move(cm));
+    }
+    if (sigs.size() != h.signal_count) return false;
+
+    messages = std::move(msgs);
+    signals = std::move(sigs);
+    return true;
+  }
+
+  mutable std::mutex parse_mutex_;
+  mutable std::unique_ptr<dbcppp::INetwork> net_;
+};
+
+// Process-wide table of loaded networks keyed by canonical path. Engines
+// hold shared_ptrs; the registry only keeps weak references, so a network
+// is freed once no slot or log channel uses it. A file that changed on disk
+// is loaded afresh; engines holding the old instance keep it.
+class dbc_registry {
+ public:
+  static dbc_registry& instance() {
+    static dbc_registry reg;
+    return reg;
+  }
+
+  std::shared_ptr<const compiled_network> acquire(
+      const std::filesystem::path& file, std::string& err) {
+    std::error_code ec;
+    auto key = std::filesystem::weakly_canonical(file, ec).string();
+    if (ec) key = file.string();
+
+    std::lock_guard lk(mtx_);
+    std::erase_if(entries_, [](const auto& e) { return e.second.expired(); });
+    if (auto it = entries_.find(key); it != entries_.end()) {
+      if (auto net = it->second.lock(); net && !net->stale()) return net;
+    }
+    std::shared_ptr<const compiled_network> net =
+        compiled_network::load(file, err);
+    if (net) entries_[key] = net;
+    return net;
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    std::lock_guard lk(mtx_);
+    return static_cast<std::size_t>(
+        std::count_if(entries_.begin(), entries_.end(),
+                      [](const auto& e) { return !e.second.expired(); }));
+  }
+
+ private:
+  mutable std::mutex mtx_;
+  std::unordered_map<std::string, std::weak_ptr<const compiled_network>>
+      entries_;
+};
+
+}  // namespace jcan
@@ -2,11 +2,13 @@
 
 #include <libserialport.h>
 
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <string>
+#include <string_view>
 
 #if !defined(_WIN32) && (defined(JCAN_HAS_VECTOR) || defined(JCAN_HAS_KVASER))
 #include <libusb.h>
@@ -514,6 +516,27 @@ namespace jcan
             .friendly_name = "Virtual CAN-FD Adapter",
         });
 
+        // Extra load-generator ports, ';'-separated, e.g.
+        // JCAN_MOCK_PORTS="mock1:rate=500000,ids=1024;mockfd1:rate=100000"
+        if (const char* extra = std::getenv("JCAN_MOCK_PORTS"))
+        {
+            std::string_view list(extra);
+            while (!list.empty())
+            {
+                auto sep = list.find(';');
+                auto port = list.substr(0, sep);
+                list = sep == std::string_view::npos ? std::string_view{} : list.substr(sep + 1);
+                if (port.empty())
+                    continue;
+                bool fd = port.starts_with("mockfd");
+                out.push_back(device_descriptor{
+                    .kind = fd ? adapter_kind::mock_fd : adapter_kind::mock,
+                    .port = std::string(port),
+                    .friendly_name = std::format("Virtual Load Generator ({})", port),
+                });
+            }
+        }
+
         return out;
     }
 
@@ -1,72 +1,183 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstddef>
-#include <mutex>
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "types.hpp"
 
 namespace jcan {
 
+inline constexpr std::size_t k_cache_line = 64;
+
+// Single-producer / single-consumer ring. When the consumer falls behind the
+// producer overwrites the oldest frames; the consumer detects the lap on its
+// next read and accounts the lost frames in dropped().
 template <std::size_t capacity = 4096>
 class frame_buffer {
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                "frame_buffer capacity must be a power of two");
+
  public:
   bool push(const can_frame& frame) {
-    std::lock_guard lock(mtx_);
-    buf_[head_] = frame;
-    head_ = (head_ + 1) % capacity;
-    if (count_ < capacity) {
-      ++count_;
-      return true;
+    auto w = head_.load(std::memory_order_relaxed);
+    claim_.store(w + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    buf_[w & k_mask] = frame;
+    head_.store(w + 1, std::memory_order_release);
+
+    if (w - cached_tail_ < capacity) return true;
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    return w - cached_tail_ < capacity;
+  }
+
+  // Producer-side bulk write: fill the front of the returned span, then
+  // commit what was used. The span only covers slots the consumer is done
+  // with (up to the wrap point), so nothing unread is claimed before it is
+  // written. When the ring is full the span is a staging area that commit()
+  // pushes from, overwriting only as many old frames as were received.
+  [[nodiscard]] std::span<can_frame> prepare(std::size_t max) {
+    auto w = head_.load(std::memory_order_relaxed);
+    if (w - cached_tail_ + max > capacity)
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    auto used = std::min<uint64_t>(w - cached_tail_, capacity);
+    auto free = static_cast<std::size_t>(capacity - used);
+    staged_ = free == 0;
+    if (staged_) {
+      staging_.resize(max);
+      return staging_;
+    }
+    auto first = static_cast<std::size_t>(w & k_mask);
+    return {buf_.data() + first, std::min({max, capacity - first, free})};
+  }
+
+  void commit(std::size_t n) {
+    if (staged_) {
+      for (std::size_t i = 0; i < n; ++i) push(staging_[i]);
+      return;
     }
-    tail_ = (tail_ + 1) % capacity;
-    return false;
+    auto w = head_.load(std::memory_order_relaxed);
+    head_.store(w + n, std::memory_order_release);
   }
 
   [[nodiscard]] std::optional<can_frame> pop() {
-    std::lock_guard lock(mtx_);
-    if (count_ == 0) return std::nullopt;
-    auto& f = buf_[tail_];
-    tail_ = (tail_ + 1) % capacity;
-    --count_;
-    return f;
+    auto t = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      auto h = head_.load(std::memory_order_acquire);
+      t = skip_lapped(t, h);
+      if (t == h) return std::nullopt;
+
+      can_frame f = buf_[t & k_mask];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      auto c = claim_.load(std::memory_order_relaxed);
+      ++t;
+      if (c - (t - 1) <= capacity) {
+        tail_.store(t, std::memory_order_release);
+        return f;
+      }
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
   }
 
   [[nodiscard]] std::vector<can_frame> drain() {
-    std::lock_guard lock(mtx_);
     std::vector<can_frame> out;
-    out.reserve(count_);
-    while (count_ > 0) {
-      out.push_back(buf_[tail_]);
-      tail_ = (tail_ + 1) % capacity;
-      --count_;
-    }
+    drain_into(out);
     return out;
   }
 
+  std::size_t drain_into(std::vector<can_frame>& out) {
+    auto t = tail_.load(std::memory_order_relaxed);
+    auto h = head_.load(std::memory_order_acquire);
+    t = skip_lapped(t, h);
+    auto n = static_cast<std::size_t>(h - t);
+    if (n == 0) return 0;
+
+    auto base = out.size();
+    auto first = static_cast<std::size_t>(t & k_mask);
+    auto split = std::min(n, capacity - first);
+    out.insert(out.end(), buf_.begin() + first, buf_.begin() + first + split);
+    out.insert(out.end(), buf_.begin(), buf_.begin() + (n - split));
+
+    auto torn = overwritten_since(t, n);
+    if (torn > 0) {
+      auto it = out.begin() + static_cast<std::ptrdiff_t>(base);
+      out.erase(it, it + static_cast<std::ptrdiff_t>(torn));
+    }
+    tail_.store(h, std::memory_order_release);
+    return n - torn;
+  }
+
+  std::size_t drain_into(std::span<can_frame> out) {
+    auto t = tail_.load(std::memory_order_relaxed);
+    auto h = head_.load(std::memory_order_acquire);
+    t = skip_lapped(t, h);
+    auto n = std::min(static_cast<std::size_t>(h - t), out.size());
+    if (n == 0) return 0;
+
+    auto first = static_cast<std::size_t>(t & k_mask);
+    auto split = std::min(n, capacity - first);
+    std::copy_n(buf_.begin() + first, split, out.begin());
+    std::copy_n(buf_.begin(), n - split, out.begin() + split);
+
+    auto torn = overwritten_since(t, n);
+    if (torn > 0) std::move(out.begin() + torn, out.begin() + n, out.begin());
+    tail_.store(t + n, std::memory_order_release);
+    return n - torn;
+  }
+
   [[nodiscard]] std::size_t size() const {
-    std::lock_guard lock(mtx_);
-    return count_;
+    auto h = head_.load(std::memory_order_acquire);
+    auto t = tail_.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(std::min<uint64_t>(h - t, capacity));
   }
 
-  [[nodiscard]] bool empty() const {
-    std::lock_guard lock(mtx_);
-    return count_ == 0;
+  [[nodiscard]] bool empty() const { return size() == 0; }
+
+  [[nodiscard]] uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
   }
 
   void clear() {
-    std::lock_guard lock(mtx_);
-    head_ = tail_ = count_ = 0;
+    tail_.store(head_.load(std::memory_order_acquire),
+                std::memory_order_release);
   }
 
  private:
-  mutable std::mutex mtx_;
-  std::array<can_frame, capacity> buf_{};
-  std::size_t head_{0};
-  std::size_t tail_{0};
-  std::size_t count_{0};
+  static constexpr uint64_t k_mask = capacity - 1;
+
+  uint64_t skip_lapped(uint64_t t, uint64_t h) {
+    if (h - t <= capacity) return t;
+    dropped_.fetch_add(h - t - capacity, std::memory_order_relaxed);
+    return h - capacity;
+  }
+
+  // Entries read starting at index t are only valid if the producer had not
+  // yet claimed their slot for a newer frame when the copy finished.
+  std::size_t overwritten_since(uint64_t t, std::size_t n) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto c = claim_.load(std::memory_order_relaxed);
+    if (c - t <= capacity) return 0;
+    auto torn = static_cast<std::size_t>(
+        std::min<uint64_t>(c - capacity - t, n));
+    dropped_.fetch_add(torn, std::memory_order_relaxed);
+    return torn;
+  }
+
+  alignas(k_cache_line) std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> claim_{0};
+  uint64_t cached_tail_{0};
+  std::vector<can_frame> staging_;
+  bool staged_{false};
+
+  alignas(k_cache_line) std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  alignas(k_cache_line) std::array<can_frame, capacity> buf_{};
 };
 
 }  // namespace jcan
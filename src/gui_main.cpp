@@ -9,6 +9,7 @@
 #include <cstdio>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <thread>
 
@@ -164,6 +165,7 @@ int main() {
     state.show_statistics = settings.show_statistics;
     state.show_plotter = settings.show_plotter;
     state.log_dir = settings.effective_log_dir();
+    state.use_io_reactor = settings.io_reactor;
 
     (void)settings.dbc_paths;
 
@@ -189,7 +191,10 @@ int main() {
     std::string pending_dbc_path;
     jcan::widgets::plotter_state plotter;
 
+    state.start_pipeline();
+
     while (!glfwWindowShouldClose(window)) {
+      std::unique_lock data_lock(state.data_mutex);
       glfwPollEvents();
 
       bool focused = glfwGetWindowAttrib(window, GLFW_FOCUSED);
@@ -201,7 +206,7 @@ int main() {
       }
 
       if (iconified) {
-        state.poll_frames();
+        data_lock.unlock();
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
         continue;
       }
@@ -240,7 +245,7 @@ int main() {
         if (ImGui::BeginMenu("File")) {
           if (state.log_mode && !state.imported_frames.empty()) {
             {
-              if (ImGui::BeginMenu("Log DBC")) {
+              if (ImGui::BeginMenu("Log DBC", !state.importing.load())) {
                 for (uint8_t ch : state.log_channels) {
                   ImGui::PushID(ch);
                   auto it = state.log_dbc.find(ch);
@@ -297,8 +302,13 @@ int main() {
             auto label = std::format("Exporting... {:.0f}%%", pct);
             ImGui::MenuItem(label.c_str(), nullptr, false, false);
           }
+          if (state.importing.load()) {
+            auto pct = state.import_progress.load() * 100.f;
+            auto label = std::format("Importing... {:.0f}%%", pct);
+            ImGui::MenuItem(label.c_str(), nullptr, false, false);
+          }
           if (ImGui::MenuItem("Import Log...", "Ctrl+I", false,
-                              !file_dialog.busy())) {
+                              !file_dialog.busy() && !state.importing.load())) {
             if (state.connected) {
               pending_import_confirm = true;
             } else {
@@ -455,6 +465,10 @@ int main() {
             if (!status.empty()) status += " | ";
             status += std::format("EXP {:.0f}%", state.export_progress.load() * 100.f);
           }
+          if (state.importing.load()) {
+            if (!status.empty()) status += " | ";
+            status += std::format("IMP {:.0f}%", state.import_progress.load() * 100.f);
+          }
           if (state.replaying.load()) {
             if (!status.empty()) status += " | ";
             status += std::format("{} {:.0f}%",
@@ -495,13 +509,13 @@ int main() {
         pending_dialog = dialog_id::export_log;
       }
       if (state.log_mode && io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_O) &&
-          !file_dialog.busy()) {
+          !file_dialog.busy() && !state.importing.load()) {
         pending_dbc_channel = state.log_channels.empty() ? uint8_t{0} : *state.log_channels.begin();
         file_dialog.open_file({{"DBC Files", "dbc"}});
         pending_dialog = dialog_id::open_dbc;
       }
       if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_I) &&
-          !file_dialog.busy()) {
+          !file_dialog.busy() && !state.importing.load()) {
         if (io.KeyShift && state.log_mode) {
           file_dialog.open_file({{"All Logs", "csv,asc,ld"},
                                  {"MoTec i2", "ld"},
@@ -563,11 +577,13 @@ int main() {
         if (state.log_mode) {
           for (uint8_t ch : state.log_channels) {
             auto label = std::format("Channel {}", static_cast<int>(ch));
-            if (ImGui::MenuItem(label.c_str()))
+            if (ImGui::MenuItem(label.c_str(), nullptr, false,
+                                !state.importing.load()))
               load_into(state.log_dbc[ch], label);
           }
           if (state.log_channels.empty()) {
-            if (ImGui::MenuItem("Channel 0"))
+            if (ImGui::MenuItem("Channel 0", nullptr, false,
+                                !state.importing.load()))
               load_into(state.log_dbc[0], "Channel 0");
           }
         } else {
@@ -667,27 +683,10 @@ int main() {
                       std::format("MoTec import failed: {}", ld_result.error());
                 }
               } else {
-                std::vector<std::pair<int64_t, jcan::can_frame>> frames;
-                if (ext == ".asc")
-                  frames = jcan::frame_logger::load_asc(path_str);
-                else
-                  frames = jcan::frame_logger::load_csv(path_str);
-                if (!frames.empty()) {
-                  float dur = state.import_log(std::move(frames));
-                  state.status_text =
-                      std::format("Imported {} frames ({:.1f}s)",
-                                  state.scrollback.size(), dur);
-
-                  plotter.pending_fit = true;
-                  for (auto& c : plotter.charts)
-                    c.live_follow = false;
-                } else {
-                  auto fname = std::filesystem::path(path_str).filename().string();
-                  if (std::filesystem::file_size(path_str) == 0)
-                    state.status_text = std::format("Import failed: {} is empty", fname);
-                  else
-                    state.status_text = std::format("Import failed: no valid frames in {}", fname);
-                }
+                state.start_import(path_str);
+                state.status_text = std::format(
+                    "Importing {}...",
+                    std::filesystem::path(path_str).filename().string());
               }
             }
             break;
@@ -738,7 +737,16 @@ int main() {
         pending_dialog = dialog_id::none;
       }
 
-      state.poll_frames();
+      if (state.import_done) {
+        if (!state.import_done->message.empty())
+          state.status_text = state.import_done->message;
+        if (state.import_done->ok) {
+          plotter.pending_fit = true;
+          for (auto& c : plotter.charts)
+            c.live_follow = false;
+        }
+        state.import_done.reset();
+      }
 
       if (!state.exporting.load() && !state.export_result_msg.empty()) {
         state.status_text = state.export_result_msg;
@@ -757,6 +765,7 @@ int main() {
       if (state.show_statistics) jcan::widgets::draw_statistics(state);
 
       ImGui::Render();
+      data_lock.unlock();
       int display_w, display_h;
       glfwGetFramebufferSize(window, &display_w, &display_h);
       glViewport(0, 0, display_w, display_h);
@@ -769,6 +778,8 @@ int main() {
       if (!focused) std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
 
+    state.stop_pipeline();
+
     {
       settings.selected_bitrate = state.selected_bitrate;
       settings.show_signals = state.show_signals;
@@ -778,6 +789,7 @@ int main() {
       settings.ui_scale = state.ui_scale;
       settings.theme = static_cast<int>(state.current_theme);
       settings.log_dir = state.log_dir.string();
+      settings.io_reactor = state.use_io_reactor;
       settings.dbc_paths.clear();
       if (!state.adapter_slots.empty())
         settings.last_adapter_port = state.adapter_slots[0]->desc.port;
@@ -788,6 +800,7 @@ int main() {
       settings.save();
     }
 
+    state.import_thread.reset();
     state.export_thread.reset();
     state.logger.stop();
     state.disconnect();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <variant>
 #include <vector>
 
@@ -52,6 +53,34 @@ namespace jcan
         return std::visit([&](auto& drv) -> result<> { return drv.send(frame); }, a);
     }
 
+    // Returns how many leading frames were accepted; an error is reported only
+    // when none were. Drivers without a batched path send one frame at a time.
+    [[nodiscard]] inline result<std::size_t> adapter_send_many(adapter& a, std::span<const can_frame> frames)
+    {
+        return std::visit(
+            [&](auto& drv) -> result<std::size_t>
+            {
+                if constexpr (requires { drv.send_many(frames); })
+                    return drv.send_many(frames);
+                else
+                {
+                    std::size_t sent = 0;
+                    for (const auto& f : frames)
+                    {
+                        if (auto r = drv.send(f); !r)
+                        {
+                            if (sent > 0)
+                                return sent;
+                            return std::unexpected(r.error());
+                        }
+                        ++sent;
+                    }
+                    return sent;
+                }
+            },
+            a);
+    }
+
     [[nodiscard]] inline result<std::optional<can_frame>> adapter_recv(adapter& a, unsigned timeout_ms = 100)
     {
         return std::visit([&](auto& drv) -> result<std::optional<can_frame>> { return drv.recv(timeout_ms); }, a);
@@ -62,6 +91,41 @@ namespace jcan
         return std::visit([&](auto& drv) -> result<std::vector<can_frame>> { return drv.recv_many(timeout_ms); }, a);
     }
 
+    [[nodiscard]] inline result<std::size_t> adapter_recv_into(adapter& a, std::span<can_frame> out, unsigned timeout_ms = 100)
+    {
+        return std::visit([&](auto& drv) -> result<std::size_t> { return drv.recv_into(out, timeout_ms); }, a);
+    }
+
+    // Drivers without a set_filters() member report software so the caller
+    // filters received frames itself.
+    [[nodiscard]] inline result<filter_mode> adapter_set_filters(adapter& a, std::span<const rx_filter> filters)
+    {
+        return std::visit(
+            [&](auto& drv) -> result<filter_mode>
+            {
+                if constexpr (requires { drv.set_filters(filters); })
+                    return drv.set_filters(filters);
+                else
+                    return filter_mode::software;
+            },
+            a);
+    }
+
+    // File descriptor that becomes readable when frames arrive, or -1 for
+    // drivers that can only be serviced by blocking in recv_into().
+    [[nodiscard]] inline int adapter_poll_fd(const adapter& a)
+    {
+        return std::visit(
+            [](const auto& drv) -> int
+            {
+                if constexpr (requires { drv.poll_fd(); })
+                    return drv.poll_fd();
+                else
+                    return -1;
+            },
+            a);
+    }
+
     [[nodiscard]] inline adapter make_adapter(const device_descriptor& desc)
     {
         switch (desc.kind)
@@ -12,6 +12,7 @@
 #include <format>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <vector>
@@ -289,6 +290,7 @@ struct kvaser_usb {
   uint8_t channel_count_{1};
   uint16_t max_outstanding_tx_{0};
   uint8_t trans_id_{1};
+  rx_spill rx_spill_;
 
   bool is_mhydra_{false};
   bool use_hydra_ext_{false};
@@ -592,6 +594,7 @@ struct kvaser_usb {
     ctx_ = nullptr;
     shared_handle_ = false;
     open_ = false;
+    rx_spill_.reset();
     if (debug()) std::fprintf(stderr, "[kvaser] closed\n");
     return {};
   }
@@ -603,17 +606,24 @@ struct kvaser_usb {
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
       unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
+
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out,
+                                              unsigned timeout_ms = 100) {
     if (!open_) return std::unexpected(error_code::not_open);
-    return is_mhydra_ ? recv_many_mhydra(timeout_ms)
-                      : recv_many_leaf(timeout_ms);
+    if (rx_spill_.empty()) {
+      rx_spill_.reset();
+      auto r = is_mhydra_ ? read_mhydra(timeout_ms, rx_spill_.frames)
+                          : read_leaf(timeout_ms, rx_spill_.frames);
+      if (!r) return std::unexpected(r.error());
+    }
+    return rx_spill_.drain(out);
   }
 
  private:
@@ -667,9 +677,8 @@ struct kvaser_usb {
     return leaf_send_cmd(cmd.data(), 20);
   }
 
-  [[nodiscard]] result<std::vector<can_frame>> recv_many_leaf(
-      unsigned timeout_ms) {
-    std::vector<can_frame> frames;
+  [[nodiscard]] result<> read_leaf(unsigned timeout_ms,
+                                   std::vector<can_frame>& frames) {
     std::array<uint8_t, 3072> buf{};
 
     int transferred = 0;
@@ -677,7 +686,7 @@ struct kvaser_usb {
                                  static_cast<int>(buf.size()), &transferred,
                                  static_cast<unsigned>(timeout_ms));
 
-    if (r == LIBUSB_ERROR_TIMEOUT) return frames;
+    if (r == LIBUSB_ERROR_TIMEOUT) return {};
     if (r < 0) {
       if (debug())
         std::fprintf(stderr, "[kvaser] RX failed: %s\n",
@@ -721,7 +730,7 @@ struct kvaser_usb {
       pos += cmd_len;
     }
 
-    return frames;
+    return {};
   }
 
   [[nodiscard]] result<> discover_endpoints() {
@@ -1515,9 +1524,8 @@ struct kvaser_usb {
     return {};
   }
 
-  [[nodiscard]] result<std::vector<can_frame>> recv_many_mhydra(
-      unsigned timeout_ms) {
-    std::vector<can_frame> frames;
+  [[nodiscard]] result<> read_mhydra(unsigned timeout_ms,
+                                   std::vector<can_frame>& frames) {
     std::array<uint8_t, 4096> buf{};
 
     int transferred = 0;
@@ -1525,7 +1533,7 @@ struct kvaser_usb {
                                  static_cast<int>(buf.size()), &transferred,
                                  static_cast<unsigned>(timeout_ms));
 
-    if (r == LIBUSB_ERROR_TIMEOUT) return frames;
+    if (r == LIBUSB_ERROR_TIMEOUT) return {};
     if (r < 0) {
       if (debug())
         std::fprintf(stderr, "[kvaser] mhydra RX failed: %s\n",
@@ -1583,7 +1591,7 @@ struct kvaser_usb {
       pos += cmd_sz;
     }
 
-    return frames;
+    return {};
   }
 
   void mhydra_parse_rx_fd(const uint8_t* data, size_t len,
@@ -12,6 +12,7 @@
 #include <cstring>
 #include <format>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -387,72 +388,48 @@ struct kvaser_canlib {
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    if (!open_) return std::unexpected(error_code::not_open);
-
-    auto& a = canlib::api();
-    long id = 0;
-    uint8_t buf[64]{};
-    unsigned int dlc = 0;
-    unsigned int flags = 0;
-    unsigned long timestamp = 0;
-
-    auto stat =
-        a.canReadWait(hnd_, &id, buf, &dlc, &flags, &timestamp, timeout_ms);
-
-    if (stat == canlib::canERR_NOMSG) {
-      return std::optional<can_frame>{std::nullopt};
-    }
-    if (stat != canlib::canOK) {
-      if (debug())
-        std::fprintf(stderr, "[kvaser-canlib] canReadWait failed: %d\n", stat);
-      return std::unexpected(error_code::read_error);
-    }
-
-    can_frame f{};
-    f.timestamp = can_frame::clock::now();
-    f.id = static_cast<uint32_t>(id);
-    f.extended = (flags & canlib::canMSG_EXT) != 0;
-    f.rtr = (flags & canlib::canMSG_RTR) != 0;
-    f.error = (flags & canlib::canMSG_ERROR_FRAME) != 0;
-    f.dlc = static_cast<uint8_t>(dlc);
-    f.fd = (flags & canlib::canFDMSG_FDF) != 0;
-    f.brs = (flags & canlib::canFDMSG_BRS) != 0;
-
-    uint8_t payload_len = frame_payload_len(f);
-    std::memcpy(f.data.data(), buf, payload_len);
-
-    return std::optional<can_frame>{f};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
       unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
+
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out,
+                                              unsigned timeout_ms = 100) {
     if (!open_) return std::unexpected(error_code::not_open);
 
-    std::vector<can_frame> frames;
     auto& a = canlib::api();
+    std::size_t count = 0;
 
-    {
-      auto r = recv(timeout_ms);
-      if (!r) return std::unexpected(r.error());
-      if (r->has_value()) frames.push_back(r->value());
-    }
-
-    for (int i = 0; i < 1000; ++i) {
+    while (count < out.size()) {
       long id = 0;
       uint8_t buf[64]{};
       unsigned int dlc = 0;
       unsigned int flags = 0;
       unsigned long timestamp = 0;
 
-      auto stat =
-          a.canRead
-              ? a.canRead(hnd_, &id, buf, &dlc, &flags, &timestamp)
-              : a.canReadWait(hnd_, &id, buf, &dlc, &flags, &timestamp, 0);
+      canlib::canStatus stat;
+      if (count == 0)
+        stat = a.canReadWait(hnd_, &id, buf, &dlc, &flags, &timestamp,
+                             timeout_ms);
+      else
+        stat = a.canRead
+                   ? a.canRead(hnd_, &id, buf, &dlc, &flags, &timestamp)
+                   : a.canReadWait(hnd_, &id, buf, &dlc, &flags, &timestamp, 0);
 
       if (stat == canlib::canERR_NOMSG) break;
-      if (stat != canlib::canOK) break;
+      if (stat != canlib::canOK) {
+        if (count > 0) break;
+        if (debug())
+          std::fprintf(stderr, "[kvaser-canlib] canReadWait failed: %d\n",
+                       stat);
+        return std::unexpected(error_code::read_error);
+      }
 
-      can_frame f{};
+      auto& f = out[count++];
+      f = can_frame{};
       f.timestamp = can_frame::clock::now();
       f.id = static_cast<uint32_t>(id);
       f.extended = (flags & canlib::canMSG_EXT) != 0;
@@ -464,11 +441,9 @@ struct kvaser_canlib {
 
       uint8_t payload_len = frame_payload_len(f);
       std::memcpy(f.data.data(), buf, payload_len);
-
-      frames.push_back(f);
     }
 
-    return frames;
+    return count;
   }
 };
 
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -12,22 +19,284 @@
 
 namespace jcan {
 
+enum class mock_burst : uint8_t { steady, square, poisson };
+enum class mock_payload : uint8_t { wave, random, counter };
+
+// Synthetic load description, parsed from the part of a mock port string after
+// ':', e.g. "mock0:rate=1000000,ids=2048,fd=30,ext=10,burst=poisson,seed=7".
+//   rate     frames per second (average), up to 1e6
+//   ids      distinct IDs; when omitted the adapter's demo ID table is used
+//   ext      percent of IDs that are 29-bit
+//   fd       percent of frames that are CAN FD (random length 12..64)
+//   dlc      classic DLC, "N" or "MIN-MAX"
+//   burst    steady | square (2x rate half the period, silent the other half)
+//            | poisson (exponential inter-arrival)
+//   period   square-wave period in ms
+//   payload  wave | random | counter
+//   seed     PRNG seed; the same seed yields the same frame sequence
+struct mock_load_profile {
+  double rate_hz{10000};
+  uint32_t id_count{0};
+  uint32_t ext_pct{0};
+  uint32_t fd_pct{0};
+  uint8_t dlc_min{8};
+  uint8_t dlc_max{8};
+  mock_burst burst{mock_burst::steady};
+  double period_ms{100};
+  mock_payload payload{mock_payload::wave};
+  uint64_t seed{1};
+
+  [[nodiscard]] static std::optional<mock_load_profile> parse(
+      std::string_view port, mock_load_profile p) {
+    auto colon = port.find(':');
+    if (colon == std::string_view::npos) return p;
+    auto opts = port.substr(colon + 1);
+
+    auto to_num = [](std::string_view v, auto& out) {
+      auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), out);
+      return ec == std::errc{} && ptr == v.data() + v.size();
+    };
+
+    while (!opts.empty()) {
+      auto comma = opts.find(',');
+      auto kv = opts.substr(0, comma);
+      opts = comma == std::string_view::npos ? std::string_view{}
+                                             : opts.substr(comma + 1);
+      if (kv.empty()) continue;
+      auto eq = kv.find('=');
+      if (eq == std::string_view::npos) return std::nullopt;
+      auto key = kv.substr(0, eq);
+      auto val = kv.substr(eq + 1);
+
+      bool ok = true;
+      if (key == "rate") {
+        ok = to_num(val, p.rate_hz) && p.rate_hz > 0 && p.rate_hz <= 1e6;
+      } else if (key == "ids") {
+        ok = to_num(val, p.id_count) && p.id_count > 0;
+      } else if (key == "ext") {
+        ok = to_num(val, p.ext_pct) && p.ext_pct <= 100;
+      } else if (key == "fd") {
+        ok = to_num(val, p.fd_pct) && p.fd_pct <= 100;
+      } else if (key == "dlc") {
+        auto dash = val.find('-');
+        unsigned lo = 0, hi = 0;
+        ok = dash == std::string_view::npos
+                 ? to_num(val, lo) && (hi = lo, true)
+                 : to_num(val.substr(0, dash), lo) &&
+                       to_num(val.substr(dash + 1), hi);
+        ok = ok && lo <= hi && hi <= 8;
+        p.dlc_min = static_cast<uint8_t>(lo);
+        p.dlc_max = static_cast<uint8_t>(hi);
+      } else if (key == "burst") {
+        if (val == "steady")
+          p.burst = mock_burst::steady;
+        else if (val == "square")
+          p.burst = mock_burst::square;
+        else if (val == "poisson")
+          p.burst = mock_burst::poisson;
+        else
+          ok = false;
+      } else if (key == "period") {
+        ok = to_num(val, p.period_ms) && p.period_ms > 0;
+      } else if (key == "payload") {
+        if (val == "wave")
+          p.payload = mock_payload::wave;
+        else if (val == "random")
+          p.payload = mock_payload::random;
+        else if (val == "counter")
+          p.payload = mock_payload::counter;
+        else
+          ok = false;
+      } else if (key == "seed") {
+        ok = to_num(val, p.seed);
+      } else {
+        ok = false;
+      }
+      if (!ok) return std::nullopt;
+    }
+    return p;
+  }
+};
+
+// Paced frame source shared by the mock adapters. Frames are stamped with
+// their scheduled arrival time, so bursts are visible downstream even when
+// recv_into() is called late and returns them in one batch.
+class mock_generator {
+ public:
+  // `id_fd_lens`, one FD length per default ID, reproduces the original
+  // mockfd0 stream: fixed per-ID lengths and its slower wave.
+  void start(const mock_load_profile& profile,
+             std::span<const uint32_t> default_ids, bool default_extended,
+             std::span<const uint8_t> id_fd_lens = {}) {
+    profile_ = profile;
+    id_fd_lens_ = id_fd_lens;
+    rng_ = profile.seed ? profile.seed : 1;
+    seq_ = 0;
+    next_s_ = 0;
+    start_time_ = can_frame::clock::now();
+
+    ids_.clear();
+    extended_.clear();
+    if (profile_.id_count == 0) {
+      ids_.assign(default_ids.begin(), default_ids.end());
+      extended_.assign(ids_.size(), default_extended);
+      round_robin_ = true;
+    } else {
+      round_robin_ = false;
+      id_fd_lens_ = {};
+      for (uint32_t i = 0; i < profile_.id_count; ++i) {
+        bool ext = next_pct() < profile_.ext_pct;
+        uint32_t id = ext ? static_cast<uint32_t>(next_u64()) & 0x1FFFFFFF
+                          : (i * 0x2B5u + 0x100u) & 0x7FF;
+        ids_.push_back(id);
+        extended_.push_back(ext);
+      }
+    }
+  }
+
+  std::size_t produce(std::span<can_frame> out, unsigned timeout_ms) {
+    if (out.empty() || ids_.empty()) return 0;
+
+    double elapsed = elapsed_s();
+    if (next_s_ > elapsed) {
+      double wait = std::min(next_s_ - elapsed, timeout_ms / 1000.0);
+      std::this_thread::sleep_until(
+          can_frame::clock::now() +
+          std::chrono::duration_cast<can_frame::clock::duration>(
+              std::chrono::duration<double>(wait)));
+      elapsed = elapsed_s();
+    }
+
+    std::size_t n = 0;
+    while (n < out.size() && next_s_ <= elapsed) {
+      fill(out[n++]);
+      advance();
+    }
+    return n;
+  }
+
+ private:
+  double elapsed_s() const {
+    return std::chrono::duration<double>(can_frame::clock::now() - start_time_)
+        .count();
+  }
+
+  uint64_t next_u64() {
+    uint64_t z = (rng_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  uint32_t next_pct() { return static_cast<uint32_t>(next_u64() % 100); }
+
+  double next_unit() {
+    return static_cast<double>(next_u64() >> 11) * 0x1.0p-53;
+  }
+
+  void advance() {
+    ++seq_;
+    switch (profile_.burst) {
+      case mock_burst::steady:
+        next_s_ += 1.0 / profile_.rate_hz;
+        break;
+      case mock_burst::square: {
+        double period = profile_.period_ms / 1000.0;
+        next_s_ += 1.0 / (2.0 * profile_.rate_hz);
+        double phase = std::fmod(next_s_, period);
+        if (phase >= period / 2) next_s_ += period - phase;
+        break;
+      }
+      case mock_burst::poisson:
+        next_s_ += -std::log(1.0 - next_unit()) / profile_.rate_hz;
+        break;
+    }
+  }
+
+  void fill(can_frame& f) {
+    f = can_frame{};
+    f.timestamp =
+        start_time_ + std::chrono::duration_cast<can_frame::clock::duration>(
+                          std::chrono::duration<double>(next_s_));
+
+    auto idx = static_cast<std::size_t>(
+        round_robin_ ? seq_ % ids_.size() : next_u64() % ids_.size());
+    f.id = ids_[idx];
+    f.extended = extended_[idx];
+
+    uint8_t len;
+    if (profile_.fd_pct > 0 && next_pct() < profile_.fd_pct) {
+      static constexpr uint8_t fd_lens[] = {12, 16, 20, 24, 32, 48, 64};
+      f.fd = true;
+      f.brs = true;
+      if (!id_fd_lens_.empty())
+        len = id_fd_lens_[idx];
+      else
+        len = round_robin_ ? fd_lens[seq_ % std::size(fd_lens)]
+                           : fd_lens[next_u64() % std::size(fd_lens)];
+      f.dlc = len_to_dlc(len);
+    } else {
+      f.dlc = profile_.dlc_min == profile_.dlc_max
+                  ? profile_.dlc_min
+                  : static_cast<uint8_t>(
+                        profile_.dlc_min +
+                        next_u64() % (profile_.dlc_max - profile_.dlc_min + 1));
+      len = f.dlc;
+    }
+
+    switch (profile_.payload) {
+      case mock_payload::wave: {
+        double t = static_cast<double>(seq_) * 0.001;
+        bool fd_demo = !id_fd_lens_.empty();
+        double harmonic = fd_demo ? 0.3 : 0.7;
+        double phase = fd_demo ? 0.05 : 0.1;
+        for (uint8_t i = 0; i < len; ++i) {
+          double wave =
+              std::sin(t * (1.0 + i * harmonic) + f.id * phase) * 127.0 + 128.0;
+          f.data[i] = static_cast<uint8_t>(static_cast<int>(wave) & 0xFF);
+        }
+        break;
+      }
+      case mock_payload::random:
+        for (uint8_t i = 0; i < len; i += 8) {
+          uint64_t r = next_u64();
+          std::memcpy(&f.data[i], &r, std::min<std::size_t>(8, len - i));
+        }
+        break;
+      case mock_payload::counter:
+        std::memcpy(f.data.data(), &seq_, std::min<std::size_t>(8, len));
+        break;
+    }
+  }
+
+  mock_load_profile profile_{};
+  std::span<const uint8_t> id_fd_lens_;
+  std::vector<uint32_t> ids_;
+  std::vector<bool> extended_;
+  bool round_robin_{true};
+  uint64_t rng_{1};
+  uint64_t seq_{0};
+  double next_s_{0};
+  can_frame::clock::time_point start_time_{};
+};
+
 struct mock_adapter {
   bool open_{false};
-  uint32_t seq_{0};
-  can_frame::clock::time_point start_time_{};
+  mock_generator gen_;
 
-  static constexpr int k_target_rate = 10000;
-  static constexpr int k_batch_size = 100;
+  static constexpr uint32_t k_demo_ids[] = {
+      0x100, 0x200, 0x310, 0x400, 0x500, 0x600, 0x7DF, 0x123,
+  };
 
   [[nodiscard]] result<> open(
-      const std::string&,
+      const std::string& port,
       [[maybe_unused]] slcan_bitrate bitrate = slcan_bitrate::s6,
       [[maybe_unused]] unsigned baud = 0) {
     if (open_) return std::unexpected(error_code::already_open);
+    auto profile = mock_load_profile::parse(port, {});
+    if (!profile) return std::unexpected(error_code::port_config_failed);
+    gen_.start(*profile, k_demo_ids, false);
     open_ = true;
-    seq_ = 0;
-    start_time_ = can_frame::clock::now();
     return {};
   }
 
@@ -44,78 +313,44 @@ struct mock_adapter {
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
-      [[maybe_unused]] unsigned timeout_ms = 100) {
-    if (!open_) return std::unexpected(error_code::not_open);
-
-    static constexpr uint32_t demo_ids[] = {
-        0x100, 0x200, 0x310, 0x400, 0x500, 0x600, 0x7DF, 0x123,
-    };
-    static constexpr int n_ids =
-        static_cast<int>(sizeof(demo_ids) / sizeof(demo_ids[0]));
-
-    auto now = can_frame::clock::now();
-    double elapsed = std::chrono::duration<double>(now - start_time_).count();
-    uint32_t target_seq = static_cast<uint32_t>(elapsed * k_target_rate);
-
-    if (seq_ >= target_seq) {
-      auto wake = start_time_ + std::chrono::duration_cast<can_frame::clock::duration>(
-                                    std::chrono::duration<double>(
-                                        static_cast<double>(seq_ + 1) / k_target_rate));
-      std::this_thread::sleep_until(wake);
-      now = can_frame::clock::now();
-      elapsed = std::chrono::duration<double>(now - start_time_).count();
-      target_seq = static_cast<uint32_t>(elapsed * k_target_rate);
-    }
-
-    uint32_t to_produce = std::min(target_seq - seq_,
-                                   static_cast<uint32_t>(k_batch_size));
-
-    std::vector<can_frame> frames;
-    frames.reserve(to_produce);
-
-    for (uint32_t b = 0; b < to_produce; ++b) {
-      can_frame f{};
-      f.timestamp = now;
-      f.id = demo_ids[seq_ % n_ids];
-      f.dlc = 8;
-
-      double t = static_cast<double>(seq_) * 0.001;
-      for (uint8_t i = 0; i < 8; ++i) {
-        double wave =
-            std::sin(t * (1.0 + i * 0.7) + f.id * 0.1) * 127.0 + 128.0;
-        f.data[i] = static_cast<uint8_t>(static_cast<int>(wave) & 0xFF);
-      }
+      unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
 
-      ++seq_;
-      frames.push_back(f);
-    }
-    return frames;
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out,
+                                              unsigned timeout_ms = 100) {
+    if (!open_) return std::unexpected(error_code::not_open);
+    return gen_.produce(out, timeout_ms);
   }
 };
 
 struct mock_fd_adapter {
   bool open_{false};
-  uint64_t seq_{0};
-  can_frame::clock::time_point start_time_{};
+  mock_generator gen_;
 
-  static constexpr int k_target_rate = 2000;
-  static constexpr int k_batch_size = 20;
+  static constexpr uint32_t k_fd_ids[] = {0x18DA00FA, 0x18DB33F1, 0x0CF004FE,
+                                          0x18FEF100, 0x0CFF0003};
+  static constexpr uint8_t k_fd_lens[] = {12, 16, 24, 32, 64};
 
   [[nodiscard]] result<> open(
-      const std::string&,
+      const std::string& port,
       [[maybe_unused]] slcan_bitrate bitrate = slcan_bitrate::s6,
       [[maybe_unused]] unsigned baud = 0) {
     if (open_) return std::unexpected(error_code::already_open);
+    mock_load_profile defaults;
+    defaults.rate_hz = 2000;
+    defaults.fd_pct = 100;
+    auto profile = mock_load_profile::parse(port, defaults);
+    if (!profile) return std::unexpected(error_code::port_config_failed);
+    bool plain = port.find(':') == std::string::npos;
+    gen_.start(*profile, k_fd_ids, true,
+               plain ? std::span<const uint8_t>(k_fd_lens)
+                     : std::span<const uint8_t>{});
     open_ = true;
-    seq_ = 0;
-    start_time_ = can_frame::clock::now();
     return {};
   }
 
@@ -132,63 +367,18 @@ struct mock_fd_adapter {
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
-      [[maybe_unused]] unsigned timeout_ms = 100) {
-    if (!open_) return std::unexpected(error_code::not_open);
-
-    static constexpr uint32_t fd_ids[] = {0x18DA00FA, 0x18DB33F1, 0x0CF004FE,
-                                          0x18FEF100, 0x0CFF0003};
-    static constexpr uint8_t fd_dlcs[] = {12, 16, 24, 32, 64};
-    static constexpr int n_ids =
-        static_cast<int>(sizeof(fd_ids) / sizeof(fd_ids[0]));
-
-    auto now = can_frame::clock::now();
-    double elapsed = std::chrono::duration<double>(now - start_time_).count();
-    uint64_t target_seq = static_cast<uint64_t>(elapsed * k_target_rate);
-
-    if (seq_ >= target_seq) {
-      auto wake = start_time_ + std::chrono::duration_cast<can_frame::clock::duration>(
-                                    std::chrono::duration<double>(
-                                        static_cast<double>(seq_ + 1) / k_target_rate));
-      std::this_thread::sleep_until(wake);
-      now = can_frame::clock::now();
-      elapsed = std::chrono::duration<double>(now - start_time_).count();
-      target_seq = static_cast<uint64_t>(elapsed * k_target_rate);
-    }
-
-    uint64_t to_produce = std::min(target_seq - seq_,
-                                   static_cast<uint64_t>(k_batch_size));
-
-    std::vector<can_frame> frames;
-    frames.reserve(static_cast<std::size_t>(to_produce));
-
-    for (uint64_t b = 0; b < to_produce; ++b) {
-      can_frame f{};
-      f.timestamp = now;
-      f.id = fd_ids[seq_ % n_ids];
-      f.extended = true;
-      f.fd = true;
-      f.brs = true;
-      f.dlc = len_to_dlc(fd_dlcs[seq_ % n_ids]);
-
-      uint8_t payload_len = fd_dlcs[seq_ % n_ids];
-      double t = static_cast<double>(seq_) * 0.001;
-      for (uint8_t i = 0; i < payload_len; ++i) {
-        double wave =
-            std::sin(t * (1.0 + i * 0.3) + f.id * 0.05) * 127.0 + 128.0;
-        f.data[i] = static_cast<uint8_t>(static_cast<int>(wave) & 0xFF);
-      }
+      unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
 
-      ++seq_;
-      frames.push_back(f);
-    }
-    return frames;
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out,
+                                              unsigned timeout_ms = 100) {
+    if (!open_) return std::unexpected(error_code::not_open);
+    return gen_.produce(out, timeout_ms);
   }
 };
 
@@ -231,26 +421,32 @@ struct mock_echo_adapter {
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
-      [[maybe_unused]] unsigned timeout_ms = 100) {
+      unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
+
+  [[nodiscard]] result<std::size_t> recv_into(
+      std::span<can_frame> out, [[maybe_unused]] unsigned timeout_ms = 100) {
     if (!open_) return std::unexpected(error_code::not_open);
 
-    std::vector<can_frame> out;
+    std::size_t n = 0;
     {
       std::lock_guard lk(state_->mtx);
-      out.swap(state_->pending);
+      auto& pending = state_->pending;
+      n = std::min(out.size(), pending.size());
+      std::copy_n(pending.begin(), n, out.begin());
+      pending.erase(pending.begin(),
+                    pending.begin() + static_cast<std::ptrdiff_t>(n));
     }
 
-    if (out.empty()) {
+    if (n == 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
-    return out;
+    return n;
   }
 };
 
@@ -10,6 +10,7 @@
 #include <cstring>
 #include <format>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -21,6 +22,10 @@ struct serial_slcan {
   struct sp_port* port_{nullptr};
   bool open_{false};
   std::string rx_accum_;
+  std::string tx_accum_;
+  rx_spill rx_spill_;
+  uint32_t acceptance_code_{0x00000000};
+  uint32_t acceptance_mask_{0xFFFFFFFF};
 
   static constexpr unsigned k_default_timeout_ms = 100;
 
@@ -53,8 +58,7 @@ struct serial_slcan {
     auto br_cmd = std::format("S{}\r", static_cast<int>(bitrate));
     if (auto r = send_command(br_cmd); !r) return r;
 
-    (void)send_command("M00000000\r");
-    (void)send_command("mFFFFFFFF\r");
+    (void)send_acceptance();
 
     if (auto r = send_command("O\r"); !r) return r;
 
@@ -70,6 +74,7 @@ struct serial_slcan {
     sp_free_port(port_);
     port_ = nullptr;
     open_ = false;
+    rx_spill_.reset();
     return {};
   }
 
@@ -77,96 +82,100 @@ struct serial_slcan {
     if (!open_) return std::unexpected(error_code::not_open);
 
     std::string pkt;
-    uint8_t payload_len =
-        std::min(frame_payload_len(frame), static_cast<uint8_t>(8));
-    if (frame.extended) {
-      pkt = std::format("T{:08X}{}", frame.id, payload_len);
-    } else {
-      pkt = std::format("t{:03X}{}", frame.id & 0x7FF, payload_len);
-    }
-    for (uint8_t i = 0; i < payload_len; ++i) {
-      pkt += std::format("{:02X}", frame.data[i]);
-    }
-    pkt += '\r';
-
+    append_frame(pkt, frame);
     return send_command(pkt);
   }
 
-  [[nodiscard]] result<std::vector<can_frame>> recv_many(
-      unsigned timeout_ms = k_default_timeout_ms) {
+  [[nodiscard]] result<std::size_t> send_many(
+      std::span<const can_frame> frames) {
     if (!open_) return std::unexpected(error_code::not_open);
 
-    char buf[4096]{};
-    int n = sp_blocking_read(port_, buf, sizeof(buf) - 1, timeout_ms);
-    if (n < 0) return std::unexpected(error_code::read_error);
+    tx_accum_.clear();
+    for (const auto& f : frames) append_frame(tx_accum_, f);
+    if (tx_accum_.empty()) return std::size_t{0};
 
-    std::vector<can_frame> frames;
-    if (n == 0) return frames;
-
-    if (std::getenv("JCAN_DEBUG")) {
-      std::fprintf(stderr, "[slcan] read %d bytes:", n);
-      for (int i = 0; i < std::min(n, 80); ++i)
-        std::fprintf(stderr, " %02X", static_cast<uint8_t>(buf[i]));
-      std::fprintf(stderr, " | ");
-      for (int i = 0; i < std::min(n, 80); ++i) {
-        char c = buf[i];
-        std::fprintf(stderr, "%c", (c >= 0x20 && c < 0x7F) ? c : '.');
-      }
-      std::fprintf(stderr, "\n");
+    unsigned timeout = k_default_timeout_ms +
+                       static_cast<unsigned>(tx_accum_.size() / 8);
+    int written =
+        sp_blocking_write(port_, tx_accum_.data(), tx_accum_.size(), timeout);
+    if (written < 0) return std::unexpected(error_code::write_error);
+    if (static_cast<std::size_t>(written) == tx_accum_.size())
+      return frames.size();
+
+    // A line cut off mid-frame is finished, or terminated so the adapter
+    // rejects it, so that the next write starts on a clean line.
+    auto done = static_cast<std::size_t>(written);
+    if (done > 0 && tx_accum_[done - 1] != '\r') {
+      auto end = tx_accum_.find('\r', done) + 1;
+      int rest = sp_blocking_write(port_, tx_accum_.data() + done, end - done,
+                                   k_default_timeout_ms);
+      if (rest > 0) done += static_cast<std::size_t>(rest);
+      if (done != end)
+        (void)sp_blocking_write(port_, "\r", 1, k_default_timeout_ms);
     }
+    auto complete = std::count(
+        tx_accum_.begin(), tx_accum_.begin() + static_cast<std::ptrdiff_t>(done),
+        '\r');
+    if (complete == 0) return std::unexpected(error_code::write_error);
+    return static_cast<std::size_t>(complete);
+  }
 
-    rx_accum_.append(buf, static_cast<size_t>(n));
-
-    std::size_t start = 0;
-    while (true) {
-      auto cr = rx_accum_.find('\r', start);
-      if (cr == std::string::npos) break;
-
-      std::string_view line(rx_accum_.data() + start, cr - start);
+  [[nodiscard]] int poll_fd() const {
+#ifdef _WIN32
+    return -1;
+#else
+    int fd = -1;
+    if (!open_ || sp_get_port_handle(port_, &fd) != SP_OK) return -1;
+    return fd;
+#endif
+  }
 
-      auto cmd_pos = line.find_first_of("tTrRxXF");
-      if (cmd_pos != std::string_view::npos) {
-        line = line.substr(cmd_pos);
-        auto parsed = parse_slcan(line);
-        if (parsed && parsed->has_value()) {
-          frames.push_back(parsed->value());
-          if (std::getenv("JCAN_DEBUG"))
-            std::fprintf(stderr, "[slcan] frame: id=0x%X dlc=%u\n",
-                         parsed->value().id, parsed->value().dlc);
-        } else if (std::getenv("JCAN_DEBUG")) {
-          std::fprintf(stderr, "[slcan] parse fail: '%.*s'\n",
-                       static_cast<int>(line.size()), line.data());
-        }
-      } else if (std::getenv("JCAN_DEBUG") && !line.empty()) {
-        std::fprintf(stderr, "[slcan] non-frame data: '%.*s' (",
-                     static_cast<int>(line.size()), line.data());
-        for (std::size_t i = 0; i < line.size(); ++i)
-          std::fprintf(stderr, "%02X ", static_cast<uint8_t>(line[i]));
-        std::fprintf(stderr, ")\n");
+  // The SJA1000 single-filter registers hold one code/mask pair and compare
+  // the same bits for standard and extended frames, so they can only narrow
+  // the stream; callers keep filtering in software on hardware_assisted.
+  [[nodiscard]] result<filter_mode> set_filters(
+      std::span<const rx_filter> filters) {
+    auto mode = filter_mode::software;
+    acceptance_code_ = 0x00000000;
+    acceptance_mask_ = 0xFFFFFFFF;
+    if (filters.size() == 1 && !filters[0].inverted) {
+      const auto& f = filters[0];
+      if (f.extended) {
+        acceptance_code_ = (f.id & 0x1FFFFFFF) << 3;
+        acceptance_mask_ = ~((f.mask & 0x1FFFFFFF) << 3);
+      } else {
+        acceptance_code_ = (f.id & 0x7FF) << 21;
+        acceptance_mask_ = ~((f.mask & 0x7FF) << 21);
       }
-      start = cr + 1;
+      mode = filter_mode::hardware_assisted;
     }
+    if (!open_) return mode;
 
-    if (start > 0) rx_accum_.erase(0, start);
+    (void)send_command("C\r");
+    if (auto r = send_acceptance(); !r) return std::unexpected(r.error());
+    if (auto r = send_command("O\r"); !r) return std::unexpected(r.error());
+    return mode;
+  }
 
-    if (rx_accum_.size() > 256 && rx_accum_.find('\r') == std::string::npos) {
-      if (std::getenv("JCAN_DEBUG"))
-        std::fprintf(stderr,
-                     "[slcan] flushing %zu bytes of junk from rx_accum\n",
-                     rx_accum_.size());
-      rx_accum_.clear();
-    }
-    if (rx_accum_.size() > 8192) rx_accum_.clear();
+  [[nodiscard]] result<std::vector<can_frame>> recv_many(
+      unsigned timeout_ms = k_default_timeout_ms) {
+    return recv_many_via(*this, timeout_ms);
+  }
 
-    return frames;
+  [[nodiscard]] result<std::size_t> recv_into(
+      std::span<can_frame> out, unsigned timeout_ms = k_default_timeout_ms) {
+    if (!open_) return std::unexpected(error_code::not_open);
+    if (rx_spill_.empty()) {
+      rx_spill_.reset();
+      if (auto r = read_frames(timeout_ms, rx_spill_.frames); !r)
+        return std::unexpected(r.error());
+    }
+    return rx_spill_.drain(out);
   }
 
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = k_default_timeout_ms) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] static result<std::optional<can_frame>> parse_slcan(
@@ -250,6 +259,93 @@ struct serial_slcan {
   }
 
  private:
+  [[nodiscard]] result<> read_frames(unsigned timeout_ms,
+                                     std::vector<can_frame>& frames) {
+    char buf[4096]{};
+    int n = timeout_ms == 0
+                ? sp_nonblocking_read(port_, buf, sizeof(buf) - 1)
+                : sp_blocking_read(port_, buf, sizeof(buf) - 1, timeout_ms);
+    if (n < 0) return std::unexpected(error_code::read_error);
+    if (n == 0) return {};
+
+    if (std::getenv("JCAN_DEBUG")) {
+      std::fprintf(stderr, "[slcan] read %d bytes:", n);
+      for (int i = 0; i < std::min(n, 80); ++i)
+        std::fprintf(stderr, " %02X", static_cast<uint8_t>(buf[i]));
+      std::fprintf(stderr, " | ");
+      for (int i = 0; i < std::min(n, 80); ++i) {
+        char c = buf[i];
+        std::fprintf(stderr, "%c", (c >= 0x20 && c < 0x7F) ? c : '.');
+      }
+      std::fprintf(stderr, "\n");
+    }
+
+    rx_accum_.append(buf, static_cast<size_t>(n));
+
+    std::size_t start = 0;
+    while (true) {
+      auto cr = rx_accum_.find('\r', start);
+      if (cr == std::string::npos) break;
+
+      std::string_view line(rx_accum_.data() + start, cr - start);
+
+      auto cmd_pos = line.find_first_of("tTrRxXF");
+      if (cmd_pos != std::string_view::npos) {
+        line = line.substr(cmd_pos);
+        auto parsed = parse_slcan(line);
+        if (parsed && parsed->has_value()) {
+          frames.push_back(parsed->value());
+          if (std::getenv("JCAN_DEBUG"))
+            std::fprintf(stderr, "[slcan] frame: id=0x%X dlc=%u\n",
+                         parsed->value().id, parsed->value().dlc);
+        } else if (std::getenv("JCAN_DEBUG")) {
+          std::fprintf(stderr, "[slcan] parse fail: '%.*s'\n",
+                       static_cast<int>(line.size()), line.data());
+        }
+      } else if (std::getenv("JCAN_DEBUG") && !line.empty()) {
+        std::fprintf(stderr, "[slcan] non-frame data: '%.*s' (",
+                     static_cast<int>(line.size()), line.data());
+        for (std::size_t i = 0; i < line.size(); ++i)
+          std::fprintf(stderr, "%02X ", static_cast<uint8_t>(line[i]));
+        std::fprintf(stderr, ")\n");
+      }
+      start = cr + 1;
+    }
+
+    if (start > 0) rx_accum_.erase(0, start);
+
+    if (rx_accum_.size() > 256 && rx_accum_.find('\r') == std::string::npos) {
+      if (std::getenv("JCAN_DEBUG"))
+        std::fprintf(stderr,
+                     "[slcan] flushing %zu bytes of junk from rx_accum\n",
+                     rx_accum_.size());
+      rx_accum_.clear();
+    }
+    if (rx_accum_.size() > 8192) rx_accum_.clear();
+
+    return {};
+  }
+
+  static void append_frame(std::string& out, const can_frame& frame) {
+    uint8_t payload_len =
+        std::min(frame_payload_len(frame), static_cast<uint8_t>(8));
+    if (frame.extended) {
+      out += std::format("T{:08X}{}", frame.id, payload_len);
+    } else {
+      out += std::format("t{:03X}{}", frame.id & 0x7FF, payload_len);
+    }
+    for (uint8_t i = 0; i < payload_len; ++i) {
+      out += std::format("{:02X}", frame.data[i]);
+    }
+    out += '\r';
+  }
+
+  [[nodiscard]] result<> send_acceptance() {
+    if (auto r = send_command(std::format("M{:08X}\r", acceptance_code_)); !r)
+      return r;
+    return send_command(std::format("m{:08X}\r", acceptance_mask_));
+  }
+
   [[nodiscard]] result<> send_command(const std::string& cmd) {
     int written =
         sp_blocking_write(port_, cmd.c_str(), cmd.size(), k_default_timeout_ms);
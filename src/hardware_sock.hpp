@@ -6,18 +6,26 @@
 
 #include <linux/can.h>
 #include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/ethtool.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #include <net/if.h>
 #include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <format>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -29,6 +37,28 @@ struct socket_can {
   bool fd_enabled_{false};
   std::string iface_name_;
 
+  enum class timestamp_source : uint8_t { user, kernel, hardware };
+
+  bool batched_rx_{true};
+  timestamp_source ts_source_{timestamp_source::user};
+  uint64_t rx_syscalls_{0};
+  uint64_t rx_frames_{0};
+
+  static constexpr std::size_t k_mmsg_batch = 64;
+  static constexpr std::size_t k_cmsg_len =
+      CMSG_SPACE(sizeof(struct scm_timestamping)) +
+      CMSG_SPACE(sizeof(struct timespec));
+
+  std::vector<struct canfd_frame> mmsg_frames_;
+  std::vector<struct iovec> mmsg_iov_;
+  std::vector<struct mmsghdr> mmsg_hdrs_;
+  std::vector<char> mmsg_cmsg_;
+  std::vector<struct canfd_frame> tx_frames_;
+  std::vector<struct iovec> tx_iov_;
+  std::vector<struct mmsghdr> tx_hdrs_;
+  bool hw_anchored_{false};
+  int64_t hw_offset_ns_{0};
+
   static constexpr uint32_t bitrate_bps(slcan_bitrate br) {
     constexpr uint32_t map[] = {
         10000, 20000, 50000, 100000, 125000, 250000, 500000, 800000, 1000000,
@@ -120,6 +150,10 @@ struct socket_can {
     }
 
     iface_name_ = iface_name;
+    enable_timestamps();
+    setup_mmsg();
+    if (std::getenv("JCAN_SOCKETCAN_NO_MMSG")) batched_rx_ = false;
+
     open_ = true;
     return {};
   }
@@ -141,104 +175,280 @@ struct socket_can {
   [[nodiscard]] result<> send(const can_frame& frame) {
     if (!open_) return std::unexpected(error_code::not_open);
 
-    if (frame.fd && fd_enabled_) {
-      struct canfd_frame cfd{};
-      cfd.can_id = frame.id;
-      if (frame.extended) cfd.can_id |= CAN_EFF_FLAG;
-      if (frame.rtr) cfd.can_id |= CAN_RTR_FLAG;
-      cfd.len = frame_payload_len(frame);
-      cfd.flags = frame.brs ? CANFD_BRS : 0;
-      std::memcpy(cfd.data, frame.data.data(), cfd.len);
-      ssize_t n = ::write(fd_, &cfd, sizeof(cfd));
-      if (n != sizeof(cfd)) return std::unexpected(error_code::write_error);
-    } else {
-      struct ::can_frame cf{};
-      cf.can_id = frame.id;
-      if (frame.extended) cf.can_id |= CAN_EFF_FLAG;
-      if (frame.rtr) cf.can_id |= CAN_RTR_FLAG;
-      cf.can_dlc = std::min(frame.dlc, static_cast<uint8_t>(8));
-      std::memcpy(cf.data, frame.data.data(), cf.can_dlc);
-      ssize_t n = ::write(fd_, &cf, sizeof(cf));
-      if (n != sizeof(cf)) return std::unexpected(error_code::write_error);
-    }
+    struct canfd_frame raw{};
+    auto len = to_raw(frame, raw);
+    ssize_t n = ::write(fd_, &raw, len);
+    if (n != static_cast<ssize_t>(len))
+      return std::unexpected(error_code::write_error);
     return {};
   }
 
+  [[nodiscard]] result<std::size_t> send_many(
+      std::span<const can_frame> frames) {
+    if (!open_) return std::unexpected(error_code::not_open);
+    if (tx_hdrs_.empty()) {
+      tx_frames_.resize(k_mmsg_batch);
+      tx_iov_.resize(k_mmsg_batch);
+      tx_hdrs_.resize(k_mmsg_batch);
+    }
+
+    std::size_t sent = 0;
+    while (sent < frames.size()) {
+      auto n = std::min(frames.size() - sent, k_mmsg_batch);
+      for (std::size_t i = 0; i < n; ++i) {
+        tx_frames_[i] = {};
+        tx_iov_[i].iov_base = &tx_frames_[i];
+        tx_iov_[i].iov_len = to_raw(frames[sent + i], tx_frames_[i]);
+        tx_hdrs_[i] = {};
+        tx_hdrs_[i].msg_hdr.msg_iov = &tx_iov_[i];
+        tx_hdrs_[i].msg_hdr.msg_iovlen = 1;
+      }
+      int r = ::sendmmsg(fd_, tx_hdrs_.data(), static_cast<unsigned>(n), 0);
+      if (r <= 0) {
+        if (sent > 0) return sent;
+        return std::unexpected(error_code::write_error);
+      }
+      sent += static_cast<std::size_t>(r);
+    }
+    return sent;
+  }
+
   [[nodiscard]] result<std::optional<can_frame>> recv(
       unsigned timeout_ms = 100) {
-    auto batch = recv_many(timeout_ms);
-    if (!batch) return std::unexpected(batch.error());
-    if (batch->empty()) return std::optional<can_frame>{std::nullopt};
-    return std::optional<can_frame>{batch->front()};
+    return recv_one_via(*this, timeout_ms);
   }
 
   [[nodiscard]] result<std::vector<can_frame>> recv_many(
       unsigned timeout_ms = 100) {
+    return recv_many_via(*this, timeout_ms);
+  }
+
+  [[nodiscard]] int poll_fd() const { return open_ ? fd_ : -1; }
+
+  [[nodiscard]] result<filter_mode> set_filters(
+      std::span<const rx_filter> filters) {
     if (!open_) return std::unexpected(error_code::not_open);
 
-    std::vector<can_frame> frames;
+    std::vector<struct can_filter> raw;
+    raw.reserve(filters.size());
+    for (const auto& f : filters) {
+      struct can_filter cf{};
+      cf.can_id = f.id | (f.extended ? CAN_EFF_FLAG : 0) |
+                  (f.inverted ? CAN_INV_FILTER : 0);
+      cf.can_mask =
+          (f.mask & (f.extended ? CAN_EFF_MASK : CAN_SFF_MASK)) | CAN_EFF_FLAG;
+      raw.push_back(cf);
+    }
+    if (raw.empty()) raw.push_back({0, 0});
+
+    if (::setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FILTER, raw.data(),
+                     static_cast<socklen_t>(raw.size() *
+                                            sizeof(struct can_filter))) < 0)
+      return std::unexpected(error_code::port_config_failed);
+    return filter_mode::hardware;
+  }
+
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out,
+                                              unsigned timeout_ms = 100) {
+    if (!open_) return std::unexpected(error_code::not_open);
+    if (out.empty()) return std::size_t{0};
 
     struct pollfd pfd{};
     pfd.fd = fd_;
     pfd.events = POLLIN;
 
     int ready = ::poll(&pfd, 1, static_cast<int>(timeout_ms));
+    ++rx_syscalls_;
     if (ready < 0) return std::unexpected(error_code::read_error);
-    if (ready == 0) return frames;
-
-    while (true) {
-      if (fd_enabled_) {
-        struct canfd_frame cfd{};
-        ssize_t n = ::read(fd_, &cfd, sizeof(cfd));
-        if (n == sizeof(struct canfd_frame)) {
-          can_frame f{};
-          f.timestamp = can_frame::clock::now();
-          f.id = cfd.can_id & CAN_EFF_MASK;
-          f.extended = (cfd.can_id & CAN_EFF_FLAG) != 0;
-          f.rtr = (cfd.can_id & CAN_RTR_FLAG) != 0;
-          f.error = (cfd.can_id & CAN_ERR_FLAG) != 0;
-          f.fd = true;
-          f.brs = (cfd.flags & CANFD_BRS) != 0;
-          f.dlc = len_to_dlc(cfd.len);
-          std::memcpy(f.data.data(), cfd.data, cfd.len);
-          frames.push_back(f);
-        } else if (n == sizeof(struct ::can_frame)) {
-          auto* cf = reinterpret_cast<struct ::can_frame*>(&cfd);
-          can_frame f{};
-          f.timestamp = can_frame::clock::now();
-          f.id = cf->can_id & CAN_EFF_MASK;
-          f.extended = (cf->can_id & CAN_EFF_FLAG) != 0;
-          f.rtr = (cf->can_id & CAN_RTR_FLAG) != 0;
-          f.error = (cf->can_id & CAN_ERR_FLAG) != 0;
-          f.dlc = cf->can_dlc;
-          std::memcpy(f.data.data(), cf->data,
-                      std::min(f.dlc, static_cast<uint8_t>(8)));
-          frames.push_back(f);
-        } else {
-          break;
-        }
-      } else {
-        struct ::can_frame cf{};
-        ssize_t n = ::read(fd_, &cf, sizeof(cf));
-        if (n != sizeof(cf)) break;
-
-        can_frame f{};
-        f.timestamp = can_frame::clock::now();
-        f.id = cf.can_id & CAN_EFF_MASK;
-        f.extended = (cf.can_id & CAN_EFF_FLAG) != 0;
-        f.rtr = (cf.can_id & CAN_RTR_FLAG) != 0;
-        f.error = (cf.can_id & CAN_ERR_FLAG) != 0;
-        f.dlc = cf.can_dlc;
-        std::memcpy(f.data.data(), cf.data,
-                    std::min(f.dlc, static_cast<uint8_t>(8)));
-        frames.push_back(f);
-      }
+    if (ready == 0) return std::size_t{0};
+
+    auto count = batched_rx_ ? recv_batched(out) : recv_sequential(out, pfd);
+    rx_frames_ += count;
+    return count;
+  }
+
+ private:
+  std::size_t to_raw(const can_frame& frame, struct canfd_frame& raw) const {
+    raw.can_id = frame.id;
+    if (frame.extended) raw.can_id |= CAN_EFF_FLAG;
+    if (frame.rtr) raw.can_id |= CAN_RTR_FLAG;
+    if (frame.fd && fd_enabled_) {
+      raw.len = frame_payload_len(frame);
+      raw.flags = frame.brs ? CANFD_BRS : 0;
+      std::memcpy(raw.data, frame.data.data(), raw.len);
+      return sizeof(struct canfd_frame);
+    }
+    raw.len = std::min(frame.dlc, static_cast<uint8_t>(8));
+    std::memcpy(raw.data, frame.data.data(), raw.len);
+    return sizeof(struct ::can_frame);
+  }
+
+  static bool from_raw(const struct canfd_frame& raw, ssize_t n,
+                       can_frame& f) {
+    if (n != sizeof(struct canfd_frame) && n != sizeof(struct ::can_frame))
+      return false;
+    f = can_frame{};
+    f.id = raw.can_id & CAN_EFF_MASK;
+    f.extended = (raw.can_id & CAN_EFF_FLAG) != 0;
+    f.rtr = (raw.can_id & CAN_RTR_FLAG) != 0;
+    f.error = (raw.can_id & CAN_ERR_FLAG) != 0;
+    if (n == sizeof(struct canfd_frame)) {
+      f.fd = true;
+      f.brs = (raw.flags & CANFD_BRS) != 0;
+      f.dlc = len_to_dlc(raw.len);
+      std::memcpy(f.data.data(), raw.data, std::min<uint8_t>(raw.len, 64));
+    } else {
+      f.dlc = raw.len;
+      std::memcpy(f.data.data(), raw.data,
+                  std::min(f.dlc, static_cast<uint8_t>(8)));
+    }
+    return true;
+  }
 
-      ready = ::poll(&pfd, 1, 0);
+  std::size_t recv_sequential(std::span<can_frame> out, struct pollfd& pfd) {
+    std::size_t count = 0;
+    while (count < out.size()) {
+      struct canfd_frame raw{};
+      ssize_t n = ::read(fd_, &raw, fd_enabled_ ? sizeof(raw)
+                                                : sizeof(struct ::can_frame));
+      ++rx_syscalls_;
+      if (!from_raw(raw, n, out[count])) break;
+      out[count].timestamp = can_frame::clock::now();
+      ++count;
+
+      int ready = ::poll(&pfd, 1, 0);
+      ++rx_syscalls_;
       if (ready <= 0) break;
     }
+    return count;
+  }
 
-    return frames;
+  std::size_t recv_batched(std::span<can_frame> out) {
+    if (mmsg_hdrs_.empty() || mmsg_hdrs_[0].msg_hdr.msg_iov != &mmsg_iov_[0])
+      setup_mmsg();
+    std::size_t count = 0;
+    while (count < out.size()) {
+      auto want = std::min(out.size() - count, k_mmsg_batch);
+      for (std::size_t i = 0; i < want; ++i) {
+        auto& hdr = mmsg_hdrs_[i].msg_hdr;
+        hdr.msg_controllen = k_cmsg_len;
+        hdr.msg_flags = 0;
+      }
+
+      int n = ::recvmmsg(fd_, mmsg_hdrs_.data(), static_cast<unsigned>(want),
+                         MSG_DONTWAIT, nullptr);
+      ++rx_syscalls_;
+      if (n <= 0) break;
+
+      auto steady_now = can_frame::clock::now();
+      struct timespec real_now{};
+      ::clock_gettime(CLOCK_REALTIME, &real_now);
+
+      for (int i = 0; i < n; ++i) {
+        auto& f = out[count];
+        if (!from_raw(mmsg_frames_[static_cast<std::size_t>(i)],
+                      mmsg_hdrs_[static_cast<std::size_t>(i)].msg_len, f))
+          continue;
+        f.timestamp = kernel_timestamp(
+            mmsg_hdrs_[static_cast<std::size_t>(i)].msg_hdr, steady_now,
+            to_ns(real_now));
+        ++count;
+      }
+      if (static_cast<std::size_t>(n) < want) break;
+    }
+    return count;
+  }
+
+  static int64_t to_ns(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+  }
+
+  // Kernel software stamps are CLOCK_REALTIME and are mapped onto the steady
+  // clock by their age at the time of the batch. Hardware stamps live in the
+  // controller's own time base, so they are anchored to the software stamp of
+  // the first frame and re-anchored if the two drift apart.
+  can_frame::clock::time_point kernel_timestamp(
+      struct msghdr& hdr, can_frame::clock::time_point steady_now,
+      int64_t real_now_ns) {
+    int64_t sw_ns = 0;
+    int64_t hw_ns = 0;
+    for (auto* c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(&hdr, c)) {
+      if (c->cmsg_level != SOL_SOCKET) continue;
+      if (c->cmsg_type == SO_TIMESTAMPING) {
+        struct scm_timestamping ts{};
+        std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+        sw_ns = to_ns(ts.ts[0]);
+        hw_ns = to_ns(ts.ts[2]);
+      } else if (c->cmsg_type == SO_TIMESTAMPNS) {
+        struct timespec ts{};
+        std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+        sw_ns = to_ns(ts);
+      }
+    }
+
+    auto sw_time = steady_now;
+    if (sw_ns > 0)
+      sw_time -= std::chrono::nanoseconds(std::max<int64_t>(real_now_ns - sw_ns, 0));
+    if (hw_ns <= 0 || ts_source_ != timestamp_source::hardware) return sw_time;
+
+    auto sw_steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            sw_time.time_since_epoch())
+                            .count();
+    constexpr int64_t k_reanchor_ns = 50'000'000;
+    if (!hw_anchored_ ||
+        std::abs(sw_steady_ns - (hw_ns + hw_offset_ns_)) > k_reanchor_ns) {
+      hw_offset_ns_ = sw_steady_ns - hw_ns;
+      hw_anchored_ = true;
+    }
+    return can_frame::clock::time_point(
+        std::chrono::duration_cast<can_frame::clock::duration>(
+            std::chrono::nanoseconds(hw_ns + hw_offset_ns_)));
+  }
+
+  void enable_timestamps() {
+    ts_source_ = timestamp_source::user;
+    hw_anchored_ = false;
+
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                     sizeof(flags)) == 0) {
+      struct ifreq ifr{};
+      struct ethtool_ts_info info{};
+      info.cmd = ETHTOOL_GET_TS_INFO;
+      std::strncpy(ifr.ifr_name, iface_name_.c_str(), IFNAMSIZ - 1);
+      ifr.ifr_data = reinterpret_cast<char*>(&info);
+      bool hw = ::ioctl(fd_, SIOCETHTOOL, &ifr) == 0 &&
+                (info.so_timestamping & SOF_TIMESTAMPING_RAW_HARDWARE);
+      ts_source_ = hw ? timestamp_source::hardware : timestamp_source::kernel;
+    } else {
+      int on = 1;
+      if (::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0)
+        ts_source_ = timestamp_source::kernel;
+    }
+
+    if (std::getenv("JCAN_DEBUG"))
+      std::fprintf(stderr, "[socketcan] timestamps: %s\n",
+                   ts_source_ == timestamp_source::hardware ? "hardware"
+                   : ts_source_ == timestamp_source::kernel ? "kernel"
+                                                            : "user");
+  }
+
+  void setup_mmsg() {
+    mmsg_frames_.assign(k_mmsg_batch, {});
+    mmsg_iov_.assign(k_mmsg_batch, {});
+    mmsg_hdrs_.assign(k_mmsg_batch, {});
+    mmsg_cmsg_.assign(k_mmsg_batch * k_cmsg_len, 0);
+    for (std::size_t i = 0; i < k_mmsg_batch; ++i) {
+      mmsg_iov_[i].iov_base = &mmsg_frames_[i];
+      mmsg_iov_[i].iov_len = fd_enabled_ ? sizeof(struct canfd_frame)
+                                         : sizeof(struct ::can_frame);
+      auto& hdr = mmsg_hdrs_[i].msg_hdr;
+      hdr.msg_iov = &mmsg_iov_[i];
+      hdr.msg_iovlen = 1;
+      hdr.msg_control = &mmsg_cmsg_[i * k_cmsg_len];
+      hdr.msg_controllen = k_cmsg_len;
+    }
   }
 };
 
@@ -265,6 +475,10 @@ struct socket_can {
   [[nodiscard]] result<std::vector<can_frame>> recv_many(unsigned = 100) {
     return std::unexpected(error_code::not_open);
   }
+  [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame>,
+                                              unsigned = 100) {
+    return std::unexpected(error_code::not_open);
+  }
 };
 
 }  // namespace jcan
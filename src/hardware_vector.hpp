@@ -12,6 +12,7 @@
 #include <format>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <vector>
@@ -45,6 +46,7 @@ namespace jcan
         inline constexpr unsigned k_cmd_timeout_ms = 2000;
         inline constexpr unsigned k_rx_timeout_ms = 50;
         inline constexpr unsigned k_tx_timeout_ms = 500;
+        inline constexpr std::size_t k_tx_batch_bytes = 4096;
 
         inline constexpr uint32_t CMD_GET_BOOTCODE_INFO = 0x10041;
         inline constexpr uint32_t CMD_GET_FIRMWARE_INFO = 0x20002;
@@ -136,6 +138,11 @@ namespace jcan
 
         std::vector<uint8_t> rx_partial_;
         uint16_t rx_partial_expected_{0};
+        rx_spill rx_spill_;
+        std::vector<uint8_t> tx_packed_;
+        std::vector<std::size_t> tx_ends_;
+
+        static constexpr std::size_t k_tx_record_max = 132;
 
         static bool debug()
         {
@@ -333,6 +340,7 @@ namespace jcan
             ctx_ = nullptr;
             open_ = false;
             rx_partial_.clear();
+            rx_spill_.reset();
             if (debug())
                 std::fprintf(stderr, "[vector] closed\n");
             return {};
@@ -343,13 +351,91 @@ namespace jcan
             if (!open_)
                 return std::unexpected(error_code::not_open);
 
+            std::array<uint8_t, k_tx_record_max> buf{};
+            auto wire_size = encode_tx(frame, buf.data());
+
+            int transferred = 0;
+            int r = libusb_bulk_transfer(dev_, vector::k_ep_tx_data_out, buf.data(), static_cast<int>(wire_size), &transferred, vector::k_tx_timeout_ms);
+            if (r < 0)
+            {
+                if (debug())
+                    std::fprintf(stderr, "[vector] TX failed: %s\n", libusb_strerror(static_cast<libusb_error>(r)));
+                return std::unexpected(error_code::write_error);
+            }
+            return {};
+        }
+
+        // Records are self-delimiting (the same length-prefixed framing the RX
+        // path reassembles), so several frames are packed into one transfer.
+        [[nodiscard]] result<std::size_t> send_many(std::span<const can_frame> frames)
+        {
+            if (!open_)
+                return std::unexpected(error_code::not_open);
+
+            std::size_t sent = 0;
+            while (sent < frames.size())
+            {
+                tx_packed_.resize(vector::k_tx_batch_bytes);
+                tx_ends_.clear();
+                std::size_t used = 0;
+                while (sent + tx_ends_.size() < frames.size() && used + k_tx_record_max <= tx_packed_.size())
+                {
+                    used += encode_tx(frames[sent + tx_ends_.size()], tx_packed_.data() + used);
+                    tx_ends_.push_back(used);
+                }
+
+                int transferred = 0;
+                int r = libusb_bulk_transfer(dev_, vector::k_ep_tx_data_out, tx_packed_.data(), static_cast<int>(used), &transferred, vector::k_tx_timeout_ms);
+                if (r < 0)
+                {
+                    if (debug())
+                        std::fprintf(stderr, "[vector] TX batch failed after %d of %zu bytes: %s\n", transferred, used, libusb_strerror(static_cast<libusb_error>(r)));
+                    // Records the device took in full before the failure are on the bus.
+                    auto done = static_cast<std::size_t>(std::max(transferred, 0));
+                    sent += static_cast<std::size_t>(std::upper_bound(tx_ends_.begin(), tx_ends_.end(), done) - tx_ends_.begin());
+                    if (sent > 0)
+                        return sent;
+                    return std::unexpected(error_code::write_error);
+                }
+                sent += tx_ends_.size();
+            }
+            return sent;
+        }
+
+        [[nodiscard]] result<std::optional<can_frame>> recv(unsigned timeout_ms = 100)
+        {
+            return recv_one_via(*this, timeout_ms);
+        }
+
+        [[nodiscard]] result<std::vector<can_frame>> recv_many(unsigned timeout_ms = 100)
+        {
+            return recv_many_via(*this, timeout_ms);
+        }
+
+        [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out, unsigned timeout_ms = 100)
+        {
+            if (!open_)
+                return std::unexpected(error_code::not_open);
+
+            if (rx_spill_.empty())
+            {
+                rx_spill_.reset();
+                if (auto r = read_events(timeout_ms, rx_spill_.frames); !r)
+                    return std::unexpected(r.error());
+            }
+            return rx_spill_.drain(out);
+        }
+
+    private:
+        std::size_t encode_tx(const can_frame& frame, uint8_t* buf) const
+        {
             uint8_t payload_len = frame_payload_len(frame);
 
             uint32_t inner_size = (static_cast<uint32_t>(payload_len) + 31u) & ~3u;
 
             constexpr size_t k_hdr = 4;
             uint32_t wire_size = k_hdr + inner_size;
-            std::array<uint8_t, 132> buf{};
+            std::memset(buf, 0, wire_size);
 
             auto put_le32 = [&](size_t off, uint32_t v)
             {
@@ -397,41 +483,18 @@ namespace jcan
                 for (uint8_t i = 0; i < std::min(payload_len, uint8_t{8}); ++i) std::fprintf(stderr, " %02X", frame.data[i]);
                 std::fprintf(stderr, "\n");
             }
-
-            int transferred = 0;
-            int r = libusb_bulk_transfer(dev_, vector::k_ep_tx_data_out, buf.data(), static_cast<int>(wire_size), &transferred, vector::k_tx_timeout_ms);
-            if (r < 0)
-            {
-                if (debug())
-                    std::fprintf(stderr, "[vector] TX failed: %s\n", libusb_strerror(static_cast<libusb_error>(r)));
-                return std::unexpected(error_code::write_error);
-            }
-            return {};
+            return wire_size;
         }
 
-        [[nodiscard]] result<std::optional<can_frame>> recv(unsigned timeout_ms = 100)
+        [[nodiscard]] result<> read_events(unsigned timeout_ms, std::vector<can_frame>& frames)
         {
-            auto batch = recv_many(timeout_ms);
-            if (!batch)
-                return std::unexpected(batch.error());
-            if (batch->empty())
-                return std::optional<can_frame>{std::nullopt};
-            return std::optional<can_frame>{batch->front()};
-        }
-
-        [[nodiscard]] result<std::vector<can_frame>> recv_many(unsigned timeout_ms = 100)
-        {
-            if (!open_)
-                return std::unexpected(error_code::not_open);
-
-            std::vector<can_frame> frames;
             std::array<uint8_t, 16384> buf{};
 
             int transferred = 0;
             int r = libusb_bulk_transfer(dev_, vector::k_ep_rx_data_in, buf.data(), static_cast<int>(buf.size()), &transferred, static_cast<unsigned>(timeout_ms));
 
             if (r == LIBUSB_ERROR_TIMEOUT)
-                return frames;
+                return {};
             if (r < 0)
             {
                 if (debug())
@@ -466,7 +529,7 @@ namespace jcan
                 }
                 else
                 {
-                    return frames;
+                    return {};
                 }
             }
 
@@ -493,10 +556,9 @@ namespace jcan
                 pos += evt_size;
             }
 
-            return frames;
+            return {};
         }
 
-    private:
         static uint32_t get_le32(const uint8_t* p)
         {
             return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
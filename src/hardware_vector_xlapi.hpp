@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -525,34 +526,36 @@ namespace jcan
 
         [[nodiscard]] result<std::optional<can_frame>> recv(unsigned timeout_ms = 100)
         {
-            auto batch = recv_many(timeout_ms);
-            if (!batch)
-                return std::unexpected(batch.error());
-            if (batch->empty())
-                return std::optional<can_frame>{std::nullopt};
-            return std::optional<can_frame>{batch->front()};
+            return recv_one_via(*this, timeout_ms);
         }
 
         [[nodiscard]] result<std::vector<can_frame>> recv_many(unsigned timeout_ms = 100)
+        {
+            return recv_many_via(*this, timeout_ms);
+        }
+
+        [[nodiscard]] result<std::size_t> recv_into(std::span<can_frame> out, unsigned timeout_ms = 100)
         {
             if (!open_)
                 return std::unexpected(error_code::not_open);
 
             auto& xl = vector::xlapi::get_api();
-            std::vector<can_frame> frames;
+            std::size_t count = 0;
+            if (out.empty())
+                return count;
 
             if (rx_event_)
             {
                 DWORD wait_result = WaitForSingleObject(rx_event_, timeout_ms);
                 if (wait_result == WAIT_TIMEOUT)
-                    return frames;
+                    return count;
             }
 
-            while (true)
+            while (count < out.size())
             {
                 vector::xlapi::XLevent evt{};
-                unsigned int count = 1;
-                auto s = xl.pReceive(port_, &count, &evt);
+                unsigned int event_count = 1;
+                auto s = xl.pReceive(port_, &event_count, &evt);
 
                 if (s == vector::xlapi::XL_ERR_QUEUE_IS_EMPTY)
                     break;
@@ -591,11 +594,11 @@ namespace jcan
                         std::fprintf(stderr, "\n");
                     }
 
-                    frames.push_back(f);
+                    out[count++] = f;
                 }
             }
 
-            return frames;
+            return count;
         }
     };
 
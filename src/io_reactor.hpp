@@ -0,0 +1,128 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+
+namespace jcan {
+
+// One epoll thread serving every adapter that exposes a pollable fd. Handlers
+// run on the reactor thread when their fd is readable or has a pending error
+// (a SocketCAN link going down), so recv can consume it. On hang-up the fd
+// is dropped and its optional hang-up handler runs instead. remove() waits
+// for an in-flight handler, so the adapter may be closed as soon as it
+// returns.
+class io_reactor {
+ public:
+  using handler = std::function<void()>;
+
+  io_reactor() = default;
+  io_reactor(const io_reactor&) = delete;
+  io_reactor& operator=(const io_reactor&) = delete;
+
+  ~io_reactor() {
+    thread_.reset();
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+  }
+
+  [[nodiscard]] bool add(int fd, handler fn, handler on_hangup = {}) {
+    if (fd < 0 || !ensure_started()) return false;
+    std::lock_guard lk(mtx_);
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+    handlers_[fd] = {std::move(fn), std::move(on_hangup)};
+    return true;
+  }
+
+  void remove(int fd) {
+    std::lock_guard lk(mtx_);
+    if (handlers_.erase(fd) == 0) return;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    std::lock_guard lk(mtx_);
+    return handlers_.size();
+  }
+
+ private:
+  bool ensure_started() {
+    if (thread_) return true;
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) return false;
+
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    thread_.emplace([this](std::stop_token stop) { run(stop); });
+    return true;
+  }
+
+  void run(std::stop_token stop) {
+    std::stop_callback wake(stop, [this] {
+      uint64_t one = 1;
+      (void)::write(wake_fd_, &one, sizeof(one));
+    });
+
+    std::array<struct epoll_event, 16> events{};
+    while (!stop.stop_requested()) {
+      int n = ::epoll_wait(epoll_fd_, events.data(),
+                           static_cast<int>(events.size()), -1);
+      if (n < 0) continue;
+
+      std::lock_guard lk(mtx_);
+      for (int i = 0; i < n; ++i) {
+        const auto& ev = events[static_cast<std::size_t>(i)];
+        if (ev.data.fd == wake_fd_) continue;
+        auto it = handlers_.find(ev.data.fd);
+        if (it == handlers_.end()) continue;
+
+        if (ev.events & EPOLLHUP) {
+          if (std::getenv("JCAN_DEBUG"))
+            std::fprintf(stderr, "[reactor] fd %d hung up, removing\n",
+                         ev.data.fd);
+          ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ev.data.fd, nullptr);
+          auto on_hangup = std::move(it->second.on_hangup);
+          handlers_.erase(it);
+          if (on_hangup) on_hangup();
+          continue;
+        }
+        it->second.on_ready();
+      }
+    }
+  }
+
+  struct entry {
+    handler on_ready;
+    handler on_hangup;
+  };
+
+  int epoll_fd_{-1};
+  int wake_fd_{-1};
+  mutable std::mutex mtx_;
+  std::unordered_map<int, entry> handlers_;
+  std::optional<std::jthread> thread_;
+};
+
+}  // namespace jcan
+
+#endif
@@ -6,6 +6,7 @@
 #include <stop_token>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "discovery.hpp"
 #include "frame_buffer.hpp"
@@ -83,8 +84,10 @@ int main() {
                            "[DLC]", "DATA");
   std::cout << std::string(60, '-') << '\n';
 
+  std::vector<jcan::can_frame> frames;
   while (true) {
-    auto frames = buf.drain();
+    frames.clear();
+    buf.drain_into(frames);
     for (const auto& f : frames) print_frame(f);
 
     if (frames.empty())
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jcan {
+
+// Gorilla-style compression of a sample column pair: timestamps as
+// delta-of-delta in a few variable-width buckets, values as the XOR with
+// the previous value keeping only its meaningful bits. Periodic signals
+// with steady values cost a couple of bits per sample. Streams are word
+// arrays so they can sit in memory or in a spill file alike.
+namespace sample_codec {
+
+// Zigzagged delta-of-delta widths after a 1..4 bit prefix; sized for
+// nanosecond ticks (±8 us, ±0.5 ms, ±2 s of jitter, then anything).
+inline constexpr std::array<unsigned, 4> k_dod_bits{14, 20, 32, 64};
+
+// MSB-first bit packer appending to a word vector.
+class bit_writer {
+ public:
+  explicit bit_writer(std::vector<uint64_t>& out) : out_(out) {}
+
+  // Writes the low n bits of `bits`, 1 <= n <= 64.
+  void write(uint64_t bits, unsigned n) {
+    if (n < 64) bits &= (uint64_t{1} << n) - 1;
+    if (fill_ == 0) out_.push_back(0);
+    unsigned room = 64 - fill_;
+    if (n <= room) {
+      out_.back() |= bits << (room - n);
+      fill_ = (fill_ + n) & 63;
+    } else {
+      out_.back() |= bits >> (n - room);
+      out_.push_back(bits << (64 - (n - room)));
+      fill_ = n - room;
+    }
+  }
+
+ private:
+  std::vector<uint64_t>& out_;
+  unsigned fill_{0};
+};
+
+class bit_reader {
+ public:
+  explicit bit_reader(std::span<const uint64_t> words) : words_(words) {}
+
+  // Reads n bits, 1 <= n <= 64.
+  uint64_t read(unsigned n) {
+    auto word = pos_ >> 6;
+    auto off = static_cast<unsigned>(pos_ & 63);
+    uint64_t v = (words_[word] << off) >> (64 - n);
+    if (n > 64 - off) v |= words_[word + 1] >> (128 - off - n);
+    pos_ += n;
+    return v;
+  }
+
+  bool bit() { return read(1) != 0; }
+
+ private:
+  std::span<const uint64_t> words_;
+  std::size_t pos_{0};
+};
+
+inline uint64_t zigzag(uint64_t v) {
+  return (v << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(v) >> 63);
+}
+inline uint64_t unzigzag(uint64_t z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+// Appends the encoding of a non-empty column pair to `out`.
+inline void encode(std::span<const int64_t> times,
+                   std::span<const double> values,
+                   std::vector<uint64_t>& out) {
+  bit_writer w(out);
+  auto prev_t = static_cast<uint64_t>(times[0]);
+  auto prev_v = std::bit_cast<uint64_t>(values[0]);
+  w.write(prev_t, 64);
+  w.write(prev_v, 64);
+
+  uint64_t prev_delta = 0;
+  unsigned lead = 64;
+  unsigned trail = 0;
+  for (std::size_t i = 1; i < times.size(); ++i) {
+    auto t = static_cast<uint64_t>(times[i]);
+    auto delta = t - prev_t;
+    auto z = zigzag(delta - prev_delta);
+    prev_t = t;
+    prev_delta = delta;
+    if (z == 0) {
+      w.write(0, 1);
+    } else {
+      unsigned b = 0;
+      while (b + 1 < k_dod_bits.size() && z >> k_dod_bits[b]) ++b;
+      // Prefixes 10, 110, 1110, 1111.
+      if (b + 1 < k_dod_bits.size())
+        w.write(((uint64_t{1} << (b + 1)) - 1) << 1, b + 2);
+      else
+        w.write(0b1111, 4);
+      w.write(z, k_dod_bits[b]);
+    }
+
+    auto v = std::bit_cast<uint64_t>(values[i]);
+    auto x = v ^ prev_v;
+    prev_v = v;
+    if (x == 0) {
+      w.write(0, 1);
+      continue;
+    }
+    auto l = static_cast<unsigned>(std::countl_zero(x));
+    auto r = static_cast<unsigned>(std::countr_zero(x));
+    if (lead <= l && trail <= r) {
+      w.write(0b10, 2);
+      w.write(x >> trail, 64 - lead - trail);
+    } else {
+      lead = l;
+      trail = r;
+      w.write(0b11, 2);
+      w.write(lead, 6);
+      w.write(63 - lead - trail, 6);
+      w.write(x >> trail, 64 - lead - trail);
+    }
+  }
+}
+
+// Streaming inverse of encode(); each next() yields one sample in order.
+class decoder {
+ public:
+  explicit decoder(std::span<const uint64_t> words) : in_(words) {}
+
+  void next(int64_t& t, double& v) {
+    if (first_) {
+      first_ = false;
+      t_ = in_.read(64);
+      v_ = in_.read(64);
+    } else {
+      if (in_.bit()) {
+        unsigned b = 0;
+        while (b + 1 < k_dod_bits.size() && in_.bit()) ++b;
+        delta_ += unzigzag(in_.read(k_dod_bits[b]));
+      }
+      t_ += delta_;
+
+      if (in_.bit()) {
+        if (in_.bit()) {
+          lead_ = static_cast<unsigned>(in_.read(6));
+          trail_ = 63 - lead_ - static_cast<unsigned>(in_.read(6));
+        }
+        v_ ^= in_.read(64 - lead_ - trail_) << trail_;
+      }
+    }
+    t = static_cast<int64_t>(t_);
+    v = std::bit_cast<double>(v_);
+  }
+
+ private:
+  bit_reader in_;
+  bool first_{true};
+  uint64_t t_{0};
+  uint64_t v_{0};
+  uint64_t delta_{0};
+  unsigned lead_{0};
+  unsigned trail_{0};
+};
+
+inline void decode(std::span<const uint64_t> words, std::span<int64_t> times,
+                   std::span<double> values) {
+  decoder d(words);
+  for (std::size_t i = 0; i < times.size(); ++i) d.next(times[i], values[i]);
+}
+
+}  // namespace sample_codec
+
+}  // namespace jcan
@@ -22,6 +22,7 @@ struct settings {
   float ui_scale{1.0f};
   int theme{0};
   std::string log_dir;
+  bool io_reactor{false};
 
   static std::filesystem::path default_log_dir() {
 #ifdef _WIN32
@@ -94,6 +95,7 @@ struct settings {
     ofs << "ui_scale=" << ui_scale << "\n";
     ofs << "theme=" << theme << "\n";
     ofs << "log_dir=" << log_dir << "\n";
+    ofs << "io_reactor=" << (io_reactor ? 1 : 0) << "\n";
 
     return true;
   }
@@ -162,6 +164,7 @@ struct settings {
     }
     theme = std::clamp(get_int("theme", 0), 0, 5);
     log_dir = get_str("log_dir");
+    io_reactor = get_int("io_reactor", 0) != 0;
 
     return true;
   }
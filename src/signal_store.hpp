@@ -1,12 +1,20 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <deque>
+#include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "sample_codec.hpp"
+#include "spill_file.hpp"
+
 namespace jcan {
 
 struct signal_sample {
@@ -39,57 +47,540 @@ struct channel_info {
   signal_sample::clock::time_point last_time{};
 };
 
+// One channel's samples as a run of fixed-size chunks, each with a header
+// holding its time and value range. Every chunk but the last is full, so a
+// logical index maps to a chunk in O(1); time seeks binary-search the chunk
+// headers, then one chunk. Trimming advances `head_` and frees chunks once
+// they are passed.
+//
+// Each chunk also keeps min/max per 16 and per 128 samples, updated on
+// push. With the chunk headers these form a pyramid that summarize() uses
+// to cover a range with as few entries as the caller's resolution allows.
+//
+// Only the last chunk holds plain columns. A chunk that fills up is sealed:
+// its columns are compressed with sample_codec and, once attached to a
+// spill_file, moved there so only its header stays in memory. Readers
+// decode sealed chunks a whole chunk at a time into a small cache, which
+// makes the const readers single-threaded, like the UI that calls them.
+//
+// Consecutive equal values are kept as runs: a run stores only its first
+// and last sample, and pushing the same value again moves the last one
+// forward. Readers see the same step shape from far fewer samples, so an
+// index counts stored samples rather than pushes.
+class sample_series {
+ public:
+  using clock = signal_sample::clock;
+  static constexpr std::size_t k_chunk_samples = 1024;
+  static constexpr std::array<std::size_t, 2> k_level_span{16, 128};
+
+  struct value_range {
+    double lo;
+    double hi;
+  };
+
+  // Words of a sealed chunk: each level's ranges, then the codec stream.
+  static constexpr std::array<std::size_t, 2> k_level_offset{
+      0, 2 * k_chunk_samples / k_level_span[0]};
+  static constexpr std::size_t k_stream_offset =
+      k_level_offset[1] + 2 * k_chunk_samples / k_level_span[1];
+
+  struct chunk {
+    int64_t t_first{0};
+    int64_t t_last{0};
+    double v_min{0};
+    double v_max{0};
+    double v_first{0};
+    double v_last{0};
+    // Open chunk only.
+    std::vector<int64_t> times;
+    std::vector<double> values;
+    std::array<std::vector<value_range>, k_level_span.size()> levels;
+    // Sealed chunk only: in memory, or in the spill file.
+    std::vector<uint64_t> packed;
+    std::span<uint64_t> spilled;
+    uint64_t serial{0};
+
+    [[nodiscard]] bool sealed() const { return serial != 0; }
+    [[nodiscard]] std::size_t size() const {
+      return sealed() ? k_chunk_samples : times.size();
+    }
+    [[nodiscard]] std::span<const uint64_t> words() const {
+      if (!spilled.empty()) return spilled;
+      return packed;
+    }
+    [[nodiscard]] value_range level_at(std::size_t l, std::size_t i) const {
+      if (!sealed()) return levels[l][i];
+      value_range r;
+      std::memcpy(&r, words().data() + k_level_offset[l] + 2 * i, sizeof(r));
+      return r;
+    }
+  };
+
+  // Aggregate of a run of consecutive samples.
+  struct summary {
+    int64_t t_first;
+    int64_t t_last;
+    double v_min;
+    double v_max;
+    double v_first;
+    double v_last;
+  };
+
+  static int64_t to_ticks(clock::time_point t) {
+    return t.time_since_epoch().count();
+  }
+  static clock::time_point from_ticks(int64_t ticks) {
+    return clock::time_point(clock::duration(ticks));
+  }
+
+  [[nodiscard]] std::size_t size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  [[nodiscard]] signal_sample at(std::size_t i) const {
+    auto [c, k] = locate(i);
+    auto [times, values] = columns(chunks_[c]);
+    return {from_ticks(times[k]), values[k]};
+  }
+  [[nodiscard]] signal_sample front() const { return at(0); }
+  [[nodiscard]] signal_sample back() const { return at(size_ - 1); }
+
+  // Index of the first sample at or after t (lower_bound) / after t
+  // (upper_bound).
+  [[nodiscard]] std::size_t lower_bound(clock::time_point t) const {
+    return seek(to_ticks(t), false);
+  }
+  [[nodiscard]] std::size_t upper_bound(clock::time_point t) const {
+    return seek(to_ticks(t), true);
+  }
+
+  // Calls fn(times, values) with contiguous column slices covering samples
+  // [first, last), decoding sealed chunks one at a time. The slices are only
+  // valid during the call.
+  template <typename Fn>
+  void scan(std::size_t first, std::size_t last, Fn&& fn) const {
+    last = std::min(last, size_);
+    while (first < last) {
+      auto [c, k] = locate(first);
+      auto [times, values] = columns(chunks_[c]);
+      auto n = std::min(times.size() - k, last - first);
+      fn(times.subspan(k, n), values.subspan(k, n));
+      first += n;
+    }
+  }
+
+  // Covers samples [first, last) in order with summaries of at most
+  // max_span samples each: whole chunks where they fit, then 128- and
+  // 16-sample buckets, then single samples at unaligned edges.
+  template <typename Fn>
+  void summarize(std::size_t first, std::size_t last, std::size_t max_span,
+                 Fn&& fn) const {
+    last = std::min(last, size_);
+    while (first < last) {
+      auto [c, k] = locate(first);
+      const auto& ch = chunks_[c];
+      auto end = std::min(ch.size(), k + (last - first));
+      if (k == 0 && end == ch.size() && end <= max_span) {
+        fn(summary{ch.t_first, ch.t_last, ch.v_min, ch.v_max, ch.v_first,
+                   ch.v_last});
+        first += end;
+        continue;
+      }
+      auto [times, values] = columns(ch);
+      std::size_t step = 1;
+      for (std::size_t l = k_level_span.size(); l-- > 0;) {
+        auto span = k_level_span[l];
+        if (span > max_span || k % span != 0 || k + span > end) continue;
+        auto r = ch.level_at(l, k / span);
+        fn(summary{times[k], times[k + span - 1], r.lo, r.hi, values[k],
+                   values[k + span - 1]});
+        step = span;
+        break;
+      }
+      if (step == 1) {
+        auto t = times[k];
+        auto v = values[k];
+        fn(summary{t, t, v, v, v, v});
+      }
+      first += step;
+    }
+  }
+
+  void push(int64_t t, double v) {
+    if (extends_run(v)) {
+      auto& ch = chunks_.back();
+      ch.times.back() = t;
+      if (ch.times.size() == 1) ch.t_first = t;
+      ch.t_last = t;
+      return;
+    }
+    if (chunks_.empty() || chunks_.back().size() == k_chunk_samples) {
+      if (!chunks_.empty()) seal(chunks_.back());
+      auto& ch = chunks_.emplace_back();
+      ch.times.reserve(k_first_reserve);
+      ch.values.reserve(k_first_reserve);
+      ch.t_first = t;
+      ch.v_min = ch.v_max = ch.v_first = v;
+    }
+    auto& ch = chunks_.back();
+    add_to_levels(ch, ch.times.size(), v);
+    ch.times.push_back(t);
+    ch.values.push_back(v);
+    ch.t_last = t;
+    ch.v_last = v;
+    ch.v_min = std::min(ch.v_min, v);
+    ch.v_max = std::max(ch.v_max, v);
+    ++size_;
+  }
+
+  // Appends a column; one that starts before the last sample (two sources
+  // feeding one key) is merged with the overlapping tail.
+  void append(std::span<const clock::time_point> times,
+              std::span<const double> values) {
+    if (times.empty()) return;
+    if (!empty() && to_ticks(times.front()) < chunks_.back().t_last) {
+      std::vector<int64_t> ticks(times.size());
+      std::transform(times.begin(), times.end(), ticks.begin(), to_ticks);
+      merge(ticks, values);
+      return;
+    }
+    for (std::size_t i = 0; i < times.size(); ++i)
+      push(to_ticks(times[i]), values[i]);
+  }
+
+  // Drops samples older than cutoff except the newest of them, which holds
+  // the value at the cutoff when it starts a run. A sealed front chunk is
+  // only dropped whole, so live trimming never decodes one.
+  void trim_before(int64_t cutoff) {
+    while (size_ > 1) {
+      auto& ch = chunks_.front();
+      if (chunks_.size() > 1 && chunks_[1].t_first < cutoff) {
+        size_ -= ch.size() - head_;
+        head_ = 0;
+        release(ch);
+        chunks_.pop_front();
+        continue;
+      }
+      if (ch.t_first >= cutoff || ch.sealed()) break;
+      auto times = columns(ch).first;
+      auto it = std::lower_bound(
+          times.begin() + static_cast<std::ptrdiff_t>(head_), times.end(),
+          cutoff);
+      auto older = static_cast<std::size_t>(it - times.begin()) - head_;
+      if (older > 1) {
+        head_ += older - 1;
+        size_ -= older - 1;
+      }
+      break;
+    }
+  }
+
+  void clear() {
+    for (auto& ch : chunks_) release(ch);
+    chunks_.clear();
+    head_ = 0;
+    size_ = 0;
+  }
+
+  // Moves every sealed chunk, now and from here on, into `file`, which
+  // must outlive the series.
+  void spill_to(spill_file& file) {
+    spill_ = &file;
+    for (auto& ch : chunks_) spill(ch);
+  }
+
+  // Heap and spill-file bytes held by the columns, levels and decode cache.
+  [[nodiscard]] std::size_t storage_bytes() const {
+    std::size_t n = 0;
+    for (const auto& u : unpacked_)
+      n += u.times.capacity() * sizeof(int64_t) +
+           u.values.capacity() * sizeof(double);
+    for (const auto& ch : chunks_) {
+      n += ch.times.capacity() * sizeof(int64_t) +
+           ch.values.capacity() * sizeof(double) +
+           (ch.packed.capacity() + ch.spilled.size()) * sizeof(uint64_t);
+      for (const auto& level : ch.levels)
+        n += level.capacity() * sizeof(value_range);
+    }
+    return n;
+  }
+
+  [[nodiscard]] const std::deque<chunk>& chunks() const { return chunks_; }
+  [[nodiscard]] std::size_t head() const { return head_; }
+
+ private:
+  static constexpr std::size_t k_first_reserve = 16;
+  static_assert(sizeof(value_range) == 2 * sizeof(uint64_t));
+
+  // A decoded sealed chunk.
+  struct unpacked {
+    uint64_t serial{0};
+    uint64_t used{0};
+    std::vector<int64_t> times;
+    std::vector<double> values;
+  };
+
+  static void add_to_levels(chunk& ch, std::size_t k, double v) {
+    for (std::size_t l = 0; l < k_level_span.size(); ++l) {
+      auto& level = ch.levels[l];
+      if (k % k_level_span[l] == 0) {
+        level.push_back({v, v});
+      } else {
+        level.back().lo = std::min(level.back().lo, v);
+        level.back().hi = std::max(level.back().hi, v);
+      }
+    }
+  }
+
+  // True when the last two samples both hold v, the previous one possibly
+  // at the end of a sealed chunk.
+  [[nodiscard]] bool extends_run(double v) const {
+    if (size_ < 2) return false;
+    const auto& ch = chunks_.back();
+    auto n = ch.values.size();
+    double before =
+        n >= 2 ? ch.values[n - 2] : chunks_[chunks_.size() - 2].v_last;
+    return ch.values.back() == v && before == v;
+  }
+
+  // Assigning {} would keep the capacity.
+  template <typename T>
+  static void free_storage(std::vector<T>& v) {
+    std::vector<T>().swap(v);
+  }
+
+  // Spill blocks are rounded up so freed ones get reused.
+  static std::size_t spill_bytes(std::size_t words) {
+    return (words * sizeof(uint64_t) + 511) & ~std::size_t{511};
+  }
+
+  // Two cache slots, so trimming the front chunk while the chart reads
+  // another does not decode on every call.
+  [[nodiscard]] std::pair<std::span<const int64_t>, std::span<const double>>
+  columns(const chunk& ch) const {
+    if (!ch.sealed()) return {ch.times, ch.values};
+    auto* hit = &unpacked_[unpacked_[0].used < unpacked_[1].used ? 0 : 1];
+    for (auto& u : unpacked_)
+      if (u.serial == ch.serial) hit = &u;
+    auto& slot = *hit;
+    if (slot.serial != ch.serial) {
+      slot.times.resize(k_chunk_samples);
+      slot.values.resize(k_chunk_samples);
+      sample_codec::decode(ch.words().subspan(k_stream_offset), slot.times,
+                           slot.values);
+      slot.serial = ch.serial;
+    }
+    slot.used = ++use_clock_;
+    return {slot.times, slot.values};
+  }
+
+  void seal(chunk& ch) {
+    ch.packed.resize(k_stream_offset);
+    for (std::size_t l = 0; l < k_level_span.size(); ++l)
+      std::memcpy(ch.packed.data() + k_level_offset[l], ch.levels[l].data(),
+                  ch.levels[l].size() * sizeof(value_range));
+    sample_codec::encode(ch.times, ch.values, ch.packed);
+    ch.packed.shrink_to_fit();
+    free_storage(ch.times);
+    free_storage(ch.values);
+    for (auto& level : ch.levels) free_storage(level);
+    ch.serial = ++next_serial_;
+    if (spill_) spill(ch);
+  }
+
+  void unseal(chunk& ch) {
+    if (!ch.sealed()) return;
+    auto words = ch.words();
+    ch.times.resize(k_chunk_samples);
+    ch.values.resize(k_chunk_samples);
+    sample_codec::decode(words.subspan(k_stream_offset), ch.times, ch.values);
+    for (std::size_t l = 0; l < k_level_span.size(); ++l) {
+      ch.levels[l].resize(k_chunk_samples / k_level_span[l]);
+      std::memcpy(ch.levels[l].data(), words.data() + k_level_offset[l],
+                  ch.levels[l].size() * sizeof(value_range));
+    }
+    release(ch);
+    free_storage(ch.packed);
+    ch.serial = 0;
+  }
+
+  // Leaves the chunk in memory if the file cannot grow.
+  void spill(chunk& ch) {
+    if (!spill_ || !ch.sealed() || !ch.spilled.empty()) return;
+    auto* block = static_cast<uint64_t*>(
+        spill_->allocate(spill_bytes(ch.packed.size())));
+    if (!block) return;
+    std::copy(ch.packed.begin(), ch.packed.end(), block);
+    ch.spilled = {block, ch.packed.size()};
+    free_storage(ch.packed);
+  }
+
+  void release(chunk& ch) {
+    if (ch.spilled.empty()) return;
+    spill_->release(ch.spilled.data(), spill_bytes(ch.spilled.size()));
+    ch.spilled = {};
+  }
+
+  [[nodiscard]] std::pair<std::size_t, std::size_t> locate(
+      std::size_t i) const {
+    auto pos = head_ + i;
+    return {pos / k_chunk_samples, pos % k_chunk_samples};
+  }
+
+  [[nodiscard]] std::size_t seek(int64_t t, bool after) const {
+    if (size_ == 0) return 0;
+    auto c = static_cast<std::size_t>(
+        std::partition_point(chunks_.begin(), chunks_.end(),
+                             [&](const chunk& ch) {
+                               return after ? ch.t_last <= t : ch.t_last < t;
+                             }) -
+        chunks_.begin());
+    if (c == chunks_.size()) return size_;
+    auto times = columns(chunks_[c]).first;
+    auto from = times.begin() +
+                static_cast<std::ptrdiff_t>(c == 0 ? head_ : 0);
+    auto it = after ? std::upper_bound(from, times.end(), t)
+                    : std::lower_bound(from, times.end(), t);
+    return c * k_chunk_samples + static_cast<std::size_t>(it - times.begin()) -
+           head_;
+  }
+
+  void merge(std::span<const int64_t> times, std::span<const double> values) {
+    auto from = seek(times.front(), true);
+    std::vector<int64_t> tail_t;
+    std::vector<double> tail_v;
+    tail_t.reserve(size_ - from);
+    tail_v.reserve(size_ - from);
+    scan(from, size_, [&](auto ts, auto vs) {
+      tail_t.insert(tail_t.end(), ts.begin(), ts.end());
+      tail_v.insert(tail_v.end(), vs.begin(), vs.end());
+    });
+    truncate(from);
+
+    std::size_t a = 0, b = 0;
+    while (a < tail_t.size() || b < times.size()) {
+      if (b == times.size() || (a < tail_t.size() && tail_t[a] <= times[b])) {
+        push(tail_t[a], tail_v[a]);
+        ++a;
+      } else {
+        push(times[b], values[b]);
+        ++b;
+      }
+    }
+  }
+
+  // Keeps samples [0, n).
+  void truncate(std::size_t n) {
+    if (n == 0) {
+      clear();
+      return;
+    }
+    auto [c, k] = locate(n - 1);
+    for (std::size_t i = c + 1; i < chunks_.size(); ++i) release(chunks_[i]);
+    chunks_.resize(c + 1);
+    auto& ch = chunks_.back();
+    unseal(ch);
+    ch.times.resize(k + 1);
+    ch.values.resize(k + 1);
+    ch.t_last = ch.times.back();
+    ch.v_last = ch.values.back();
+    auto [lo, hi] = std::minmax_element(ch.values.begin(), ch.values.end());
+    ch.v_min = *lo;
+    ch.v_max = *hi;
+    for (auto& level : ch.levels) level.clear();
+    for (std::size_t i = 0; i < ch.values.size(); ++i)
+      add_to_levels(ch, i, ch.values[i]);
+    size_ = n;
+  }
+
+  std::deque<chunk> chunks_;
+  std::size_t head_{0};
+  std::size_t size_{0};
+  spill_file* spill_{nullptr};
+  uint64_t next_serial_{0};
+  mutable std::array<unpacked, 2> unpacked_;
+  mutable uint64_t use_clock_{0};
+};
+
 class signal_store {
  public:
+  using channel_id = uint32_t;
+  static constexpr channel_id k_no_channel = ~channel_id{0};
   static constexpr double k_default_max_seconds = 600.0;
 
   void set_max_seconds(double s) { max_seconds_ = s; }
   double max_seconds() const { return max_seconds_; }
 
-  void push(const signal_key& key, signal_sample::clock::time_point t,
-            double value, const std::string& unit = {}, double minimum = 0.0,
-            double maximum = 0.0) {
-    auto& buf = data_[key];
-    buf.push_back({t, value});
+  // Bumped by clear(); channel ids from an older generation are invalid.
+  [[nodiscard]] uint64_t generation() const { return generation_; }
 
-    auto [it, inserted] = channels_.try_emplace(key);
-    auto& info = it->second;
-    if (inserted) info.key = key;
+  // Resolves a key to a dense channel id, creating the channel if needed.
+  channel_id intern(const signal_key& key, const std::string& unit = {},
+                    double minimum = 0.0, double maximum = 0.0) {
+    auto [it, inserted] =
+        index_.try_emplace(key, static_cast<channel_id>(infos_.size()));
+    if (inserted) {
+      infos_.emplace_back().key = key;
+      auto& series = series_.emplace_back();
+      if (spill_) series.spill_to(*spill_);
+    }
+    auto& info = infos_[it->second];
     if (!unit.empty()) info.unit = unit;
     if (minimum != maximum) {
       info.minimum = minimum;
       info.maximum = maximum;
     }
+    return it->second;
+  }
+
+  void push(channel_id id, signal_sample::clock::time_point t, double value) {
+    auto& buf = series_[id];
+    buf.push(sample_series::to_ticks(t), value);
+
+    auto& info = infos_[id];
     info.last_value = value;
     info.last_time = t;
 
-    if (max_seconds_ > 0 && (buf.size() & 63) == 0 && buf.size() > 2) {
-      auto cutoff =
-          t - std::chrono::duration_cast<signal_sample::clock::duration>(
-                  std::chrono::duration<double>(max_seconds_));
-      while (buf.size() > 1 && buf.front().time < cutoff) {
-        buf.pop_front();
-      }
-    }
+    if ((buf.size() & 63) == 0) trim(buf, t);
   }
 
-  [[nodiscard]] const std::deque<signal_sample>* samples(
-      const signal_key& key) const {
-    auto it = data_.find(key);
-    if (it == data_.end()) return nullptr;
-    return &it->second;
+  // Appends a column of samples and trims once. A column that starts before
+  // the channel's last sample (two sources feeding one key) is merged in.
+  void append(channel_id id,
+              std::span<const signal_sample::clock::time_point> times,
+              std::span<const double> values) {
+    if (times.empty()) return;
+    auto& buf = series_[id];
+    buf.append(times, values);
+
+    auto& info = infos_[id];
+    auto last = buf.back();
+    info.last_value = last.value;
+    info.last_time = last.time;
+    trim(buf, last.time);
+  }
+
+  void push(const signal_key& key, signal_sample::clock::time_point t,
+            double value, const std::string& unit = {}, double minimum = 0.0,
+            double maximum = 0.0) {
+    push(intern(key, unit, minimum, maximum), t, value);
+  }
+
+  [[nodiscard]] const sample_series* samples(const signal_key& key) const {
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    return &series_[it->second];
   }
 
   [[nodiscard]] const channel_info* channel(const signal_key& key) const {
-    auto it = channels_.find(key);
-    if (it == channels_.end()) return nullptr;
-    return &it->second;
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    return &infos_[it->second];
   }
 
   [[nodiscard]] std::vector<const channel_info*> all_channels() const {
     std::vector<const channel_info*> out;
-    out.reserve(channels_.size());
-    for (const auto& [k, v] : channels_) out.push_back(&v);
+    out.reserve(infos_.size());
+    for (const auto& v : infos_) out.push_back(&v);
     std::sort(out.begin(), out.end(), [](const auto* a, const auto* b) {
       if (a->key.msg_id != b->key.msg_id) return a->key.msg_id < b->key.msg_id;
       return a->key.name < b->key.name;
@@ -97,24 +588,55 @@ class signal_store {
     return out;
   }
 
-  [[nodiscard]] std::size_t channel_count() const { return channels_.size(); }
+  [[nodiscard]] std::size_t channel_count() const { return infos_.size(); }
 
   [[nodiscard]] std::size_t total_samples() const {
     std::size_t n = 0;
-    for (const auto& [k, v] : data_) n += v.size();
+    for (const auto& v : series_) n += v.size();
+    return n;
+  }
+
+  [[nodiscard]] std::size_t storage_bytes() const {
+    std::size_t n = 0;
+    for (const auto& v : series_) n += v.storage_bytes();
     return n;
   }
 
   void clear() {
-    data_.clear();
-    channels_.clear();
+    index_.clear();
+    infos_.clear();
+    series_.clear();
+    if (spill_) spill_->reset();
+    ++generation_;
+  }
+
+  // Moves sealed sample chunks of every channel to an anonymous session
+  // file, so a long imported log stays scrollable without living in RAM.
+  // Returns false, keeping samples resident, if the file can't be created.
+  bool enable_spill() {
+    if (!spill_) spill_ = spill_file::create();
+    if (!spill_) return false;
+    for (auto& s : series_) s.spill_to(*spill_);
+    return true;
   }
 
  private:
+  void trim(sample_series& buf, signal_sample::clock::time_point t) const {
+    if (max_seconds_ <= 0 || buf.size() <= 2) return;
+    auto cutoff =
+        t - std::chrono::duration_cast<signal_sample::clock::duration>(
+                std::chrono::duration<double>(max_seconds_));
+    buf.trim_before(sample_series::to_ticks(cutoff));
+  }
+
   double max_seconds_{k_default_max_seconds};
-  std::unordered_map<signal_key, std::deque<signal_sample>, signal_key_hash>
-      data_;
-  std::unordered_map<signal_key, channel_info, signal_key_hash> channels_;
+  uint64_t generation_{0};
+  std::unordered_map<signal_key, channel_id, signal_key_hash> index_;
+  // Deques keep channel_info and sample pointers stable as channels are added.
+  std::deque<channel_info> infos_;
+  // Declared before series_ so the mapping outlives the chunks pointing in.
+  std::unique_ptr<spill_file> spill_;
+  std::deque<sample_series> series_;
 };
 
 }  // namespace jcan
@@ -0,0 +1,201 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace jcan {
+
+// Anonymous session file that sealed sample chunks are moved into. It grows
+// in fixed-size segments, each mapped once and kept until reset(), so block
+// pointers stay valid; the kernel pages blocks in as the chart reads them
+// and drops them again under memory pressure. Segments are allocated on
+// disk up front, so a full disk fails allocate() rather than faulting on
+// the first write. The file is deleted when it is closed.
+class spill_file {
+ public:
+  static constexpr std::size_t k_segment_bytes = std::size_t{64} << 20;
+
+  // A disk-backed cache directory; the temp directory is often tmpfs,
+  // where spilling would not free any memory.
+  static std::filesystem::path default_dir() {
+    if (const char* dir = std::getenv("JCAN_SPILL_DIR"))
+      return std::filesystem::path(dir);
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if (!base) base = std::getenv("APPDATA");
+    if (!base) return {};
+    return std::filesystem::path(base) / "jcan" / "spill";
+#else
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+      return std::filesystem::path(xdg) / "jcan" / "spill";
+    const char* home = std::getenv("HOME");
+    if (!home) return {};
+    return std::filesystem::path(home) / ".cache" / "jcan" / "spill";
+#endif
+  }
+
+  static std::unique_ptr<spill_file> create(
+      std::filesystem::path dir = default_dir()) {
+    static std::atomic<uint32_t> serial{0};
+    std::error_code ec;
+    if (dir.empty()) return nullptr;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) return nullptr;
+#ifdef _WIN32
+    auto pid = static_cast<uint32_t>(::GetCurrentProcessId());
+#else
+    auto pid = static_cast<uint32_t>(::getpid());
+#endif
+    auto path = dir / std::format("jcan-{}-{}.spill", pid, serial++);
+
+    std::unique_ptr<spill_file> f(new spill_file());
+#ifdef _WIN32
+    f->file_ = ::CreateFileW(
+        path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+        FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (f->file_ == INVALID_HANDLE_VALUE) return nullptr;
+#else
+    f->fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (f->fd_ < 0) return nullptr;
+    ::unlink(path.c_str());
+#endif
+    return f;
+  }
+
+  spill_file(const spill_file&) = delete;
+  spill_file& operator=(const spill_file&) = delete;
+
+  ~spill_file() {
+    unmap_all();
+#ifdef _WIN32
+    if (file_ != INVALID_HANDLE_VALUE) ::CloseHandle(file_);
+#else
+    if (fd_ >= 0) ::close(fd_);
+#endif
+  }
+
+  // Returns a writable block of `bytes` (a multiple of 8, at most one
+  // segment), reusing a released block of the same size when there is one.
+  // nullptr when the file cannot grow.
+  void* allocate(std::size_t bytes) {
+    if (auto it = free_.find(bytes); it != free_.end() && !it->second.empty()) {
+      void* p = it->second.back();
+      it->second.pop_back();
+      return p;
+    }
+    if (bytes > k_segment_bytes) return nullptr;
+    if (segments_.empty() || k_segment_bytes - used_ < bytes) {
+      if (!map_segment()) return nullptr;
+      used_ = 0;
+    }
+    void* p = static_cast<uint8_t*>(segments_.back().data) + used_;
+    used_ += bytes;
+    return p;
+  }
+
+  void release(void* block, std::size_t bytes) {
+    free_[bytes].push_back(block);
+  }
+
+  // Invalidates every block and shrinks the file back to empty.
+  void reset() {
+    unmap_all();
+    free_.clear();
+    used_ = 0;
+#ifdef _WIN32
+    LARGE_INTEGER zero{};
+    if (::SetFilePointerEx(file_, zero, nullptr, FILE_BEGIN))
+      ::SetEndOfFile(file_);
+#else
+    (void)::ftruncate(fd_, 0);
+#endif
+  }
+
+  [[nodiscard]] std::size_t mapped_bytes() const {
+    return segments_.size() * k_segment_bytes;
+  }
+
+ private:
+  struct segment {
+    void* data{nullptr};
+#ifdef _WIN32
+    HANDLE mapping{nullptr};
+#endif
+  };
+
+  spill_file() = default;
+
+  bool map_segment() {
+    auto offset = static_cast<uint64_t>(segments_.size()) * k_segment_bytes;
+    segment seg;
+#ifdef _WIN32
+    auto end = offset + k_segment_bytes;
+    seg.mapping = ::CreateFileMappingW(file_, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(end >> 32),
+                                       static_cast<DWORD>(end), nullptr);
+    if (!seg.mapping) return false;
+    seg.data = ::MapViewOfFile(seg.mapping, FILE_MAP_WRITE,
+                               static_cast<DWORD>(offset >> 32),
+                               static_cast<DWORD>(offset), k_segment_bytes);
+    if (!seg.data) {
+      ::CloseHandle(seg.mapping);
+      return false;
+    }
+#else
+    if (::posix_fallocate(fd_, static_cast<off_t>(offset),
+                          static_cast<off_t>(k_segment_bytes)) != 0)
+      return false;
+    void* p = ::mmap(nullptr, k_segment_bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd_, static_cast<off_t>(offset));
+    if (p == MAP_FAILED) return false;
+    seg.data = p;
+#endif
+    segments_.push_back(seg);
+    return true;
+  }
+
+  void unmap_all() {
+    for (auto& seg : segments_) {
+#ifdef _WIN32
+      ::UnmapViewOfFile(seg.data);
+      ::CloseHandle(seg.mapping);
+#else
+      ::munmap(seg.data, k_segment_bytes);
+#endif
+    }
+    segments_.clear();
+  }
+
+  std::vector<segment> segments_;
+  std::size_t used_{0};
+  std::unordered_map<std::size_t, std::vector<void*>> free_;
+#ifdef _WIN32
+  HANDLE file_{INVALID_HANDLE_VALUE};
+#else
+  int fd_{-1};
+#endif
+};
+
+}  // namespace jcan
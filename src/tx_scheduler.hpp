@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "dbc_engine.hpp"
 #include "frame_buffer.hpp"
 #include "hardware.hpp"
 #include "signal_source.hpp"
@@ -37,18 +38,62 @@ struct tx_job {
     return std::chrono::duration<double>(clock::now() - start_time).count();
   }
 
-  [[nodiscard]] std::unordered_map<std::string, double> evaluate_signals()
-      const {
-    std::unordered_map<std::string, double> vals;
+  // Binds signal_sources to the message's encode slots; cheap when nothing
+  // changed. Call on the UI thread, where the engine lives.
+  void bind_encoder(const dbc_engine& eng) {
+    if (encoder_bound() && encoder_.generation == eng.generation()) return;
+    bound_names_.clear();
+    for (const auto& [name, src] : signal_sources) bound_names_.push_back(name);
+    encoder_ = eng.compile_encoder(msg_id, bound_names_);
+    bound_values_.resize(bound_names_.size());
+    bound_ = true;
+    bound_map_ = nullptr;
+  }
+
+  // The plan is kept by signal name, so it survives the job being moved or
+  // copied; only the source pointers are looked up again in the new map.
+  [[nodiscard]] bool encoder_bound() const {
+    return bound_ && bound_names_.size() == signal_sources.size();
+  }
+
+  // Evaluates the sources and encodes them into `frame` without allocating.
+  bool encode_frame() {
+    if (is_raw || !encoder_bound() || !resolve_sources()) return false;
     double t = elapsed_sec();
-    for (const auto& [name, src] : signal_sources) vals[name] = src.evaluate(t);
-    return vals;
+    for (std::size_t i = 0; i < bound_sources_.size(); ++i)
+      bound_values_[i] = bound_sources_[i]->evaluate(t);
+    dbc_engine::encode(encoder_, bound_values_, frame);
+    return true;
   }
 
+  // Drops the source pointers, e.g. after the map was replaced by one from a
+  // copy; the next encode_frame() looks them up again.
+  void unbind_sources() { bound_map_ = nullptr; }
+
   static uint32_t next_id() {
     static uint32_t counter = 0;
     return ++counter;
   }
+
+ private:
+  bool resolve_sources() {
+    if (bound_map_ == &signal_sources) return true;
+    bound_sources_.clear();
+    for (const auto& name : bound_names_) {
+      auto it = signal_sources.find(name);
+      if (it == signal_sources.end()) return false;
+      bound_sources_.push_back(&it->second);
+    }
+    bound_map_ = &signal_sources;
+    return true;
+  }
+
+  dbc_engine::encode_plan encoder_;
+  std::vector<std::string> bound_names_;
+  std::vector<const signal_source*> bound_sources_;
+  std::vector<double> bound_values_;
+  bool bound_{false};
+  const void* bound_map_{nullptr};
 };
 
 class tx_scheduler {
@@ -58,10 +103,12 @@ class tx_scheduler {
     for (auto& j : jobs_) {
       if (j.instance_id == job.instance_id) {
         j = std::move(job);
+        j.unbind_sources();
         return;
       }
     }
     jobs_.push_back(std::move(job));
+    jobs_.back().unbind_sources();
   }
 
   void remove(uint32_t instance_id) {
@@ -79,6 +126,12 @@ class tx_scheduler {
     return sent_buf_.drain();
   }
 
+  std::size_t drain_sent_into(std::vector<can_frame>& out) {
+    return sent_buf_.drain_into(out);
+  }
+
+  void discard_sent() { sent_buf_.clear(); }
+
   template <typename Fn>
   void with_jobs(Fn&& fn) {
     std::lock_guard lk(mtx_);
@@ -102,6 +155,7 @@ class tx_scheduler {
       auto now = steady_clock::now();
       float min_wait_ms = 100.f;
 
+      batch_.clear();
       {
         std::lock_guard lk(mtx_);
         for (auto& job : jobs_) {
@@ -109,12 +163,8 @@ class tx_scheduler {
           auto elapsed =
               duration<float, std::milli>(now - job.last_sent).count();
           if (elapsed >= job.period_ms) {
-            if (adapter_send(hw, job.frame)) {
-              can_frame logged = job.frame;
-              logged.tx = true;
-              logged.timestamp = can_frame::clock::now();
-              sent_buf_.push(logged);
-            }
+            job.encode_frame();
+            batch_.push_back(job.frame);
             job.last_sent = now;
             min_wait_ms = std::min(min_wait_ms, job.period_ms);
           } else {
@@ -124,6 +174,17 @@ class tx_scheduler {
         }
       }
 
+      if (!batch_.empty()) {
+        auto sent = adapter_send_many(hw, batch_);
+        auto stamp = can_frame::clock::now();
+        for (std::size_t i = 0; i < sent.value_or(0); ++i) {
+          can_frame logged = batch_[i];
+          logged.tx = true;
+          logged.timestamp = stamp;
+          sent_buf_.push(logged);
+        }
+      }
+
       if (min_wait_ms < 2.f) {
         auto deadline = now + microseconds(static_cast<int64_t>(min_wait_ms * 1000.f));
         while (steady_clock::now() < deadline) {
@@ -138,6 +199,7 @@ class tx_scheduler {
 
   std::mutex mtx_;
   std::vector<tx_job> jobs_;
+  std::vector<can_frame> batch_;
   std::optional<std::jthread> thread_;
   frame_buffer<4096> sent_buf_;
 };
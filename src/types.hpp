@@ -1,10 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <charconv>
 #include <chrono>
 #include <cstdint>
 #include <expected>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace jcan {
 
@@ -99,6 +105,124 @@ enum class error_code : uint8_t {
 template <typename T = void>
 using result = std::expected<T, error_code>;
 
+inline constexpr std::size_t k_recv_batch = 512;
+
+// Frames decoded from one transport read that did not fit the span handed to
+// recv_into(); returned by the next call before the device is read again.
+struct rx_spill {
+  std::vector<can_frame> frames;
+  std::size_t pos{0};
+
+  [[nodiscard]] bool empty() const { return pos >= frames.size(); }
+
+  void reset() {
+    frames.clear();
+    pos = 0;
+  }
+
+  std::size_t drain(std::span<can_frame> out) {
+    auto n = std::min(out.size(), frames.size() - pos);
+    std::copy_n(frames.begin() + static_cast<std::ptrdiff_t>(pos), n,
+                out.begin());
+    pos += n;
+    return n;
+  }
+};
+
+template <typename Driver>
+[[nodiscard]] result<std::vector<can_frame>> recv_many_via(
+    Driver& drv, unsigned timeout_ms) {
+  std::vector<can_frame> frames(k_recv_batch);
+  auto n = drv.recv_into(frames, timeout_ms);
+  if (!n) return std::unexpected(n.error());
+  frames.resize(*n);
+  return frames;
+}
+
+template <typename Driver>
+[[nodiscard]] result<std::optional<can_frame>> recv_one_via(
+    Driver& drv, unsigned timeout_ms) {
+  can_frame f{};
+  auto n = drv.recv_into(std::span<can_frame>(&f, 1), timeout_ms);
+  if (!n) return std::unexpected(n.error());
+  if (*n == 0) return std::optional<can_frame>{std::nullopt};
+  return std::optional<can_frame>{f};
+}
+
+// Receive acceptance filter with SocketCAN semantics: a frame passes when
+// (frame.id & mask) == (id & mask) for any filter in the list, or does not
+// match for an inverted one. An empty list accepts everything; error frames
+// are never filtered.
+struct rx_filter {
+  uint32_t id{};
+  uint32_t mask{};
+  bool extended{false};
+  bool inverted{false};
+
+  [[nodiscard]] bool matches(const can_frame& f) const noexcept {
+    bool hit = f.extended == extended && (f.id & mask) == (id & mask);
+    return hit != inverted;
+  }
+};
+
+enum class filter_mode : uint8_t {
+  software,
+  hardware_assisted,
+  hardware,
+};
+
+[[nodiscard]] inline bool filters_accept(std::span<const rx_filter> filters,
+                                         const can_frame& f) noexcept {
+  if (filters.empty() || f.error) return true;
+  return std::ranges::any_of(filters,
+                             [&](const rx_filter& r) { return r.matches(f); });
+}
+
+inline std::size_t apply_filters(std::span<const rx_filter> filters,
+                                 std::span<can_frame> frames) {
+  if (filters.empty()) return frames.size();
+  std::size_t kept = 0;
+  for (auto& f : frames)
+    if (filters_accept(filters, f)) frames[kept++] = f;
+  return kept;
+}
+
+// Parses a candump-style list: "123", "7E0:7F0", "100~700", "18DAF100:1FFFFF00"
+// separated by commas or spaces. IDs written with more than three hex digits
+// or above 0x7FF are extended.
+[[nodiscard]] inline std::optional<std::vector<rx_filter>> parse_rx_filters(
+    std::string_view text) {
+  std::vector<rx_filter> out;
+  auto parse_hex = [](std::string_view s, uint32_t& v) {
+    auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), v, 16);
+    return ec == std::errc{} && p == s.data() + s.size() && !s.empty();
+  };
+
+  while (!text.empty()) {
+    auto end = text.find_first_of(", ");
+    auto tok = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view{}
+                                         : text.substr(end + 1);
+    if (tok.empty()) continue;
+
+    rx_filter f{};
+    auto sep = tok.find_first_of(":~");
+    auto id_str = tok.substr(0, sep);
+    if (!parse_hex(id_str, f.id)) return std::nullopt;
+    f.extended = id_str.size() > 3 || f.id > 0x7FF;
+    uint32_t full = f.extended ? 0x1FFFFFFF : 0x7FF;
+    if (f.id > full) return std::nullopt;
+    f.mask = full;
+    if (sep != std::string_view::npos) {
+      f.inverted = tok[sep] == '~';
+      if (!parse_hex(tok.substr(sep + 1), f.mask)) return std::nullopt;
+      f.mask &= full;
+    }
+    out.push_back(f);
+  }
+  return out;
+}
+
 enum class adapter_kind : uint8_t {
   serial_slcan,
   socket_can,
@@ -126,9 +126,32 @@ inline void draw_connection_panel(app_state& state) {
   ImGui::Combo("Bitrate", &state.selected_bitrate, bitrate_labels,
                IM_ARRAYSIZE(bitrate_labels));
 
+  ImGui::SetNextItemWidth(250);
+  if (ImGui::InputTextWithHint("Acceptance filter", "e.g. 7E0:7F0, 18DAF100",
+                               state.rx_filter_text,
+                               sizeof(state.rx_filter_text),
+                               ImGuiInputTextFlags_EnterReturnsTrue)) {
+    if (auto parsed = parse_rx_filters(state.rx_filter_text))
+      state.set_rx_filters(std::move(*parsed));
+    else
+      state.status_text = "Invalid acceptance filter";
+  }
+  if (ImGui::IsItemHovered())
+    ImGui::SetTooltip(
+        "Comma-separated id, id:mask or id~mask (inverted), in hex.\n"
+        "Applied in the adapter where supported, in software otherwise.");
+
+#ifdef __linux__
+  ImGui::Checkbox("Shared I/O thread", &state.use_io_reactor);
+  if (ImGui::IsItemHovered())
+    ImGui::SetTooltip(
+        "Service SocketCAN and serial adapters from one epoll thread.\n"
+        "Applies to adapters connected after changing it.");
+#endif
+
   ImGui::Spacing();
 
-  bool can_connect = !state.devices.empty();
+  bool can_connect = !state.devices.empty() && !state.importing.load();
   if (!can_connect) ImGui::BeginDisabled();
   if (ImGui::Button("Connect", ImVec2(120, 0))) {
     if (state.log_mode) {
@@ -143,6 +166,8 @@ inline void draw_connection_panel(app_state& state) {
                               ImGuiWindowFlags_AlwaysAutoResize)) {
     ImGui::Text("Connecting will clear the loaded log and all overlays.");
     ImGui::Spacing();
+    bool importing = state.importing.load();
+    if (importing) ImGui::BeginDisabled();
     if (ImGui::Button("Continue", ImVec2(120, 0))) {
       state.log_mode = false;
       state.clear_monitor();
@@ -151,6 +176,7 @@ inline void draw_connection_panel(app_state& state) {
       state.connect();
       ImGui::CloseCurrentPopup();
     }
+    if (importing) ImGui::EndDisabled();
     ImGui::SameLine();
     if (ImGui::Button("Cancel", ImVec2(120, 0))) {
       ImGui::CloseCurrentPopup();
@@ -54,6 +54,22 @@ inline void draw_statistics(app_state& state) {
     ImGui::PopStyleColor();
   }
 
+  if (auto decodes = st.decode_full + st.decode_skipped; decodes > 0) {
+    auto hit = static_cast<double>(st.decode_skipped) /
+               static_cast<double>(decodes) * 100.0;
+    auto cache_text =
+        std::format("Decode skipped (payload unchanged): {} of {} ({:.1f}%)",
+                    st.decode_skipped, decodes, hit);
+    ImGui::TextUnformatted(cache_text.c_str());
+  }
+
+  if (auto dropped = state.dropped_frames(); dropped > 0) {
+    ImGui::PushStyleColor(ImGuiCol_Text, state.colors.error_text);
+    auto drop_text = std::format("Dropped (buffer overrun): {}", dropped);
+    ImGui::TextUnformatted(drop_text.c_str());
+    ImGui::PopStyleColor();
+  }
+
   ImGui::Separator();
 
   constexpr auto flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
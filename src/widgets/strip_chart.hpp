@@ -5,7 +5,6 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
-#include <deque>
 #include <format>
 #include <string>
 #include <vector>
@@ -165,22 +164,28 @@ inline bool draw_strip_chart(strip_chart_state& chart,
   }
   float view_start_sec = view_end_sec + chart.view_duration_sec;
 
-  using deque_t = std::deque<signal_sample>;
-  auto visible_range = [&](const deque_t& samps, float time_off)
-      -> std::pair<deque_t::const_iterator, deque_t::const_iterator> {
+  // Includes one sample either side of the view, so a run of equal values
+  // that starts or ends off-screen still draws across it.
+  auto visible_range = [&](const sample_series& samps, float time_off)
+      -> std::pair<std::size_t, std::size_t> {
     auto t_oldest = now - std::chrono::duration_cast<signal_sample::clock::duration>(
                              std::chrono::duration<float>(view_start_sec - time_off));
     auto t_newest = now - std::chrono::duration_cast<signal_sample::clock::duration>(
                              std::chrono::duration<float>(view_end_sec - time_off));
-    auto it_begin = std::lower_bound(samps.begin(), samps.end(), t_oldest,
-        [](const signal_sample& s, const signal_sample::clock::time_point& tp) {
-          return s.time < tp;
-        });
-    auto it_end = std::upper_bound(it_begin, samps.end(), t_newest,
-        [](const signal_sample::clock::time_point& tp, const signal_sample& s) {
-          return tp < s.time;
-        });
-    return {it_begin, it_end};
+    auto first = samps.lower_bound(t_oldest);
+    auto last = std::max(first, samps.upper_bound(t_newest));
+    if (first > 0) --first;
+    if (last < samps.size()) ++last;
+    return {first, last};
+  };
+
+  // Seconds before `now` of a sample's raw timestamp.
+  const auto now_ticks = sample_series::to_ticks(now);
+  constexpr float k_tick_sec =
+      static_cast<float>(signal_sample::clock::period::num) /
+      static_cast<float>(signal_sample::clock::period::den);
+  auto age_of = [&](int64_t ticks, float time_off) {
+    return static_cast<float>(now_ticks - ticks) * k_tick_sec + time_off;
   };
 
   auto time_to_x = [&](float sec_ago) -> float {
@@ -253,18 +258,21 @@ inline bool draw_strip_chart(strip_chart_state& chart,
       const auto* samps = ts->samples(tr.key);
       if (!samps || samps->empty()) continue;
       auto [cb, ce] = visible_range(*samps, toff);
-      for (auto it = cb; it != ce; ++it) {
-        float age = std::chrono::duration<float>(now - it->time).count() + toff;
-        float px_x = canvas_pos.x + (1.0f - (age - view_end_sec) / chart.view_duration_sec) * canvas_size.x;
-        float px_y = canvas_pos.y + (1.0f - static_cast<float>((it->value - chart.y_min) / (chart.y_max - chart.y_min))) * canvas_size.y;
-        float dx = px_x - mouse_px_x;
-        float dy = px_y - mouse_px_y;
-        float dist = dx * dx + dy * dy;
-        if (dist < best_dist) {
-          best_dist = dist;
-          best_trace = ti;
+      float off = toff;
+      samps->scan(cb, ce, [&](auto times, auto values) {
+        for (std::size_t k = 0; k < times.size(); ++k) {
+          float age = age_of(times[k], off);
+          float px_x = canvas_pos.x + (1.0f - (age - view_end_sec) / chart.view_duration_sec) * canvas_size.x;
+          float px_y = canvas_pos.y + (1.0f - static_cast<float>((values[k] - chart.y_min) / (chart.y_max - chart.y_min))) * canvas_size.y;
+          float dx = px_x - mouse_px_x;
+          float dy = px_y - mouse_px_y;
+          float dist = dx * dx + dy * dy;
+          if (dist < best_dist) {
+            best_dist = dist;
+            best_trace = ti;
+          }
         }
-      }
+      });
     }
     if (best_trace >= 0) {
       chart.rdrag_active = true;
@@ -312,11 +320,11 @@ inline bool draw_strip_chart(strip_chart_state& chart,
       if (!samps || samps->empty()) continue;
 
       auto [vb, ve] = visible_range(*samps, ya_off);
-      for (auto it = vb; it != ve; ++it) {
-        y_lo = std::min(y_lo, it->value);
-        y_hi = std::max(y_hi, it->value);
+      samps->summarize(vb, ve, ve - vb, [&](const auto& s) {
+        y_lo = std::min(y_lo, s.v_min);
+        y_hi = std::max(y_hi, s.v_max);
         has_data = true;
-      }
+      });
     }
 
     if (has_data) {
@@ -416,26 +424,31 @@ inline bool draw_strip_chart(strip_chart_state& chart,
     if (pixel_width < 1) pixel_width = 1;
     std::vector<bin> bins(static_cast<std::size_t>(pixel_width));
 
+    // Summaries no wider than a pixel's share of samples keep the cost
+    // proportional to the pixel width however many samples are visible.
     auto [rb, re] = visible_range(*samps, tr_off);
-    for (auto it = rb; it != re; ++it) {
-      const auto& s = *it;
-      float age = std::chrono::duration<float>(now - s.time).count() + tr_off;
-
-      float x = time_to_x(age);
-      int px = static_cast<int>(x - canvas_pos.x);
-      if (px < 0 || px >= pixel_width) continue;
-
-      float y = value_to_y(s.value);
+    float off = tr_off;
+    auto per_pixel = std::max<std::size_t>(
+        1, (re - rb) / static_cast<std::size_t>(pixel_width));
+    samps->summarize(rb, re, per_pixel, [&](const auto& s) {
+      float x = time_to_x(age_of(s.t_first, off)) - canvas_pos.x;
+      int px = static_cast<int>(
+          std::clamp(x, 0.0f, static_cast<float>(pixel_width - 1)));
+
+      float y_hi = value_to_y(s.v_max);
+      float y_lo = value_to_y(s.v_min);
       auto& b = bins[static_cast<std::size_t>(px)];
       if (!b.used) {
-        b.y_min = b.y_max = b.y_first = b.y_last = y;
+        b.y_min = y_hi;
+        b.y_max = y_lo;
+        b.y_first = value_to_y(s.v_first);
         b.used = true;
       } else {
-        b.y_min = std::min(b.y_min, y);
-        b.y_max = std::max(b.y_max, y);
-        b.y_last = y;
+        b.y_min = std::min(b.y_min, y_hi);
+        b.y_max = std::max(b.y_max, y_lo);
       }
-    }
+      b.y_last = value_to_y(s.v_last);
+    });
 
     float prev_x = 0.0f;
     float prev_y = 0.0f;
@@ -485,19 +498,21 @@ inline bool draw_strip_chart(strip_chart_state& chart,
 
           auto target_time = now - std::chrono::duration_cast<signal_sample::clock::duration>(
                                       std::chrono::duration<float>(cursor_age - tt_off));
-          auto tt_it = std::lower_bound(samps->begin(), samps->end(), target_time,
-              [](const signal_sample& s, const signal_sample::clock::time_point& tp) {
-                return s.time < tp;
-              });
+          auto tt_idx = samps->lower_bound(target_time);
           double best_val = 0.0;
           float best_dist = 1e30f;
-          auto check = [&](decltype(tt_it) cand) {
-            float age = std::chrono::duration<float>(now - cand->time).count() + tt_off;
+          auto check = [&](std::size_t idx) {
+            auto cand = samps->at(idx);
+            float age = std::chrono::duration<float>(now - cand.time).count() + tt_off;
             float dist = std::abs(age - cursor_age);
-            if (dist < best_dist) { best_dist = dist; best_val = cand->value; }
+            if (dist < best_dist) { best_dist = dist; best_val = cand.value; }
           };
-          if (tt_it != samps->end()) check(tt_it);
-          if (tt_it != samps->begin()) check(std::prev(tt_it));
+          if (tt_idx < samps->size()) check(tt_idx);
+          if (tt_idx > 0) check(tt_idx - 1);
+          // Inside a run the value holds however far its ends are.
+          if (tt_idx > 0 && tt_idx < samps->size() &&
+              samps->at(tt_idx - 1).value == samps->at(tt_idx).value)
+            best_dist = 0.0f;
           if (best_dist < chart.view_duration_sec) {
             ImVec4 col = ImGui::ColorConvertU32ToFloat4(tr.color);
             ImGui::TextColored(col, "%s: %.4g", tr.key.name.c_str(), best_val);
@@ -657,8 +657,8 @@ inline void draw_transmitter(app_state& state) {
         ImGui::SameLine();
         if (ImGui::Button("Send Once")) {
           if (!job.is_raw && state.any_dbc_loaded()) {
-            auto vals = job.evaluate_signals();
-            job.frame = state.dbc_for_id(job.msg_id).encode(job.msg_id, vals);
+            job.bind_encoder(state.dbc_for_id(job.msg_id));
+            job.encode_frame();
           }
           if (auto* a = state.tx_adapter()) (void)adapter_send(*a, job.frame);
         }
@@ -863,8 +863,8 @@ inline void draw_transmitter(app_state& state) {
             ImGui::EndTable();
           }
 
-          auto vals = job.evaluate_signals();
-          job.frame = eng.encode(job.msg_id, vals);
+          job.bind_encoder(eng);
+          job.encode_frame();
         }
 
         ImGui::TextDisabled("  Frame: ");